@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Общая часть бенчмарков: время, перцентили, разбор аргументов вида
+// --флаг значение и вывод результатов в JSON
+//   {"benchmark": имя, "results": [строка, ...]},
+// чтобы сравнивать прогоны между версиями.
+
+// Сюда складываются прочитанные значения, чтобы компилятор не выкинул циклы.
+inline volatile uint64_t sink = 0;
+
+inline uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+inline uint64_t Percentile(const std::vector<uint64_t>& sorted,
+                           double fraction) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(fraction * (sorted.size() - 1));
+  return sorted[index];
+}
+
+// Одна строка результатов: поля выводятся в порядке добавления. Строки
+// берутся в кавычки, числа пишутся как есть, вложенная строка - объектом.
+class BenchmarkRow {
+ public:
+  BenchmarkRow& Add(const std::string& key, const std::string& value) {
+    return add_raw(key, "\"" + value + "\"");
+  }
+
+  BenchmarkRow& Add(const std::string& key, const char* value) {
+    return Add(key, std::string(value));
+  }
+
+  template <typename Number>
+    requires std::is_arithmetic_v<Number>
+  BenchmarkRow& Add(const std::string& key, Number value) {
+    std::ostringstream text;
+    text << value;
+    return add_raw(key, text.str());
+  }
+
+  BenchmarkRow& Add(const std::string& key, const BenchmarkRow& nested) {
+    return add_raw(key, nested.ToJson());
+  }
+
+  std::string ToJson() const { return "{" + fields_ + "}"; }
+
+ private:
+  std::string fields_;
+
+  BenchmarkRow& add_raw(const std::string& key, const std::string& value) {
+    if (!fields_.empty()) {
+      fields_ += ", ";
+    }
+    fields_ += "\"" + key + "\": " + value;
+    return *this;
+  }
+};
+
+// Аргументы командной строки парами --флаг значение; незнакомые флаги
+// пропускаются.
+class BenchmarkArgs {
+ public:
+  BenchmarkArgs(int argc, char** argv) {
+    for (int ind = 1; ind + 1 < argc; ind += 2) {
+      values_[argv[ind]] = argv[ind + 1];
+    }
+  }
+
+  uint64_t Number(const std::string& flag, uint64_t fallback) const {
+    auto iter = values_.find(flag);
+    if (iter == values_.end()) {
+      return fallback;
+    }
+    return std::strtoull(iter->second.c_str(), nullptr, 10);
+  }
+
+  std::string Text(const std::string& flag,
+                   const std::string& fallback = "") const {
+    auto iter = values_.find(flag);
+    return iter == values_.end() ? fallback : iter->second;
+  }
+
+  // Куда писать JSON (--out); пустая строка - stdout.
+  std::string OutPath() const { return Text("--out"); }
+
+ private:
+  std::map<std::string, std::string> values_;
+};
+
+inline void WriteBenchmarkJson(std::ostream& out, const std::string& benchmark,
+                               const std::vector<BenchmarkRow>& results) {
+  out << "{\n  \"benchmark\": \"" << benchmark << "\",\n  \"results\": [\n";
+  for (size_t ind = 0; ind < results.size(); ++ind) {
+    out << "    " << results[ind].ToJson()
+        << (ind + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+// Пишет результаты в out_path или, если он пуст, в stdout.
+inline void WriteBenchmarkJson(const std::string& out_path,
+                               const std::string& benchmark,
+                               const std::vector<BenchmarkRow>& results) {
+  if (out_path.empty()) {
+    WriteBenchmarkJson(std::cout, benchmark, results);
+  } else {
+    std::ofstream out(out_path);
+    WriteBenchmarkJson(out, benchmark, results);
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark.hpp"
+
+// Заменяет глобальные operator new/delete счётчиками обращений к куче.
+// Замена действует на всю программу, поэтому заголовок подключается ровно
+// в одну единицу трансляции - в сам бенчмарк.
+
+inline uint64_t heap_calls = 0;
+inline uint64_t heap_bytes = 0;  // запрошено байт, освобождение не вычитается
+
+// Не встраиваются: увидев в вызывающем коде malloc/free на месте
+// operator new/delete, gcc считает пару несогласованной
+// (-Wmismatched-new-delete).
+[[gnu::noinline]] void* operator new(size_t size) {
+  ++heap_calls;
+  heap_bytes += size;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+[[gnu::noinline]] void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+// Замер участка кода: время и обращения к куче от создания до Stop().
+class HeapMeter {
+ public:
+  HeapMeter() : calls_(heap_calls), bytes_(heap_bytes), start_(NowNs()) {}
+
+  void Stop() {
+    elapsed_ = NowNs() - start_;
+    calls_ = heap_calls - calls_;
+    bytes_ = heap_bytes - bytes_;
+  }
+
+  // Дописывает к row ops и средние на операцию: ns_per_op,
+  // heap_calls_per_op и heap_bytes_per_op.
+  BenchmarkRow PerOp(BenchmarkRow row, uint64_t ops) const {
+    double count = static_cast<double>(ops);
+    row.Add("ops", ops)
+        .Add("ns_per_op", elapsed_ / count)
+        .Add("heap_calls_per_op", calls_ / count)
+        .Add("heap_bytes_per_op", bytes_ / count);
+    return row;
+  }
+
+ private:
+  uint64_t calls_;
+  uint64_t bytes_;
+  uint64_t start_;
+  uint64_t elapsed_ = 0;
+};
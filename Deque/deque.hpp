@@ -1,16 +1,104 @@
-
 #pragma once
 #include <stdlib.h>
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "cstddef"
 
-template <typename T, typename Allocator = std::allocator<T>>
+// Сколько байт должен занимать блок дека, если размер блока не задан явно.
+inline constexpr size_t kDequeBlockBytes = 4096;
+
+// Число элементов в блоке по умолчанию: наибольшая степень двойки, при
+// которой блок не больше kDequeBlockBytes, но не меньше одного элемента.
+constexpr size_t DequeBlockSize(size_t elem_size) {
+  size_t count = 1;
+  while (2 * count * elem_size <= kDequeBlockBytes) {
+    count *= 2;
+  }
+  return count;
+}
+
+// Сколько свободных блоков дек держит про запас, не отдавая аллокатору.
+inline constexpr size_t kDequeCachedBlocks = 4;
+
+// Кэш освободившихся блоков: блок, ушедший при pop, дожидается следующего
+// push, поэтому очередь в установившемся режиме не обращается к куче.
+// Хранит не больше kDequeCachedBlocks блоков, остальные возвращает
+// аллокатору. Не потокобезопасен.
+template <typename T, typename Allocator, size_t kBlockSize>
+class DequeBlockCache {
+ public:
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  explicit DequeBlockCache(const Allocator& alloc = Allocator())
+      : alloc_(alloc) {}
+
+  DequeBlockCache(const DequeBlockCache&) = delete;
+  DequeBlockCache& operator=(const DequeBlockCache&) = delete;
+
+  ~DequeBlockCache() { release(); }
+
+  T* allocate() {
+    if (cached_ > 0) {
+      ++hits_;
+      return spare_[--cached_];
+    }
+    ++misses_;
+    return alloc_traits::allocate(alloc_, kBlockSize);
+  }
+
+  void deallocate(T* block) {
+    if (cached_ < kDequeCachedBlocks) {
+      spare_[cached_++] = block;
+      return;
+    }
+    alloc_traits::deallocate(alloc_, block, kBlockSize);
+  }
+
+  // Возвращает аллокатору все запасные блоки.
+  void release() noexcept {
+    while (cached_ > 0) {
+      alloc_traits::deallocate(alloc_, spare_[--cached_], kBlockSize);
+    }
+  }
+
+  // Возвращает запасные блоки и дальше работает с аллокатором alloc.
+  void reset(const Allocator& alloc) noexcept {
+    release();
+    alloc_ = alloc;
+  }
+
+  size_t hits() const { return hits_; }
+
+  size_t misses() const { return misses_; }
+
+  size_t cached() const { return cached_; }
+
+ private:
+  Allocator alloc_;
+  T* spare_[kDequeCachedBlocks];
+  size_t cached_ = 0;
+  size_t hits_ = 0;    // блок взят из кэша
+  size_t misses_ = 0;  // блок пришлось просить у аллокатора
+};
+
+template <typename T, typename Allocator = std::allocator<T>,
+          size_t kBlockSize = DequeBlockSize(sizeof(T))>
 class Deque {
+  static_assert(std::has_single_bit(kBlockSize),
+                "block size must be a power of two");
+
  public:
   template <bool IsConst>
   class common_iterator;
@@ -23,152 +111,131 @@ class Deque {
   using allocator_type = Allocator;
   using alloc_traits = std::allocator_traits<Allocator>;
   using value_type = T;
+  using block_cache = DequeBlockCache<T, Allocator, kBlockSize>;
 
   Deque() {}
 
   Deque(const Allocator& alloc) : alloc_(alloc) {}
 
-  Deque(size_t count, const Allocator& alloc = Allocator())
-      : alloc_(alloc),
-        node_((count + kSize - 1) / kSize),
-        middle_(node_ / 2),
-        begin_(iterator(&big_arr_, -middle_, nullptr, &middle_)),
-        end_(iterator(&big_arr_, node_ - middle_ - 1, nullptr, &middle_)),
-        now_sz_(count) {
-    big_arr_.resize(node_);
-    assign_arr(0, node_);
-    if (now_sz_ != 0) {
-      begin_.curr_ = big_arr_[middle_ + begin_.index_];
-      end_.curr_ = big_arr_[middle_ + end_.index_] + (count - 1) % kSize;
-      ++end_;
+  Deque(size_t count, const Allocator& alloc = Allocator()) : alloc_(alloc) {
+    if (count == 0) {
+      return;
+    }
+    create_storage(count);
+    if constexpr (std::is_default_constructible<T>::value) {
+      construct_all(
+          [this](T* place) { alloc_traits::construct(alloc_, place); });
     }
-    filling();
   }
 
   Deque(size_t size, const T& value, const Allocator& alloc = Allocator())
-      : Deque(size, alloc) {
-    for (iterator iter = begin_; iter != end_; ++iter) {
-      try {
-        alloc_traits::construct(alloc_, iter.curr_, std::move(value));
-      } catch (...) {
-        for (iterator iter_del = iter; iter_del - begin_ > 0; --iter_del) {
-          alloc_traits::destroy(alloc_, iter_del.curr_);
-        }
-        for (int64_t counter = 0; counter < end_.index_ - begin_.index_;
-             ++counter) {
-          alloc_traits::deallocate(
-              alloc_, big_arr_[middle_ + begin_.index_ + counter], kSize);
-        }
-        throw;
-      }
+      : alloc_(alloc) {
+    if (size == 0) {
+      return;
     }
+    create_storage(size);
+    construct_all([this, &value](T* place) {
+      alloc_traits::construct(alloc_, place, value);
+    });
   }
 
   Deque(const Deque& other)
-      : alloc_(
-            alloc_traits::select_on_container_copy_construction(other.alloc_)),
-        now_sz_(other.now_sz_),
-        node_(other.node_),
-        middle_(other.middle_),
-        begin_(iterator(&big_arr_, other.begin_.index_, nullptr, &middle_)),
-        end_(iterator(&big_arr_, other.end_.index_, nullptr, &middle_)) {
-    big_arr_.resize(node_);
-    if (empty()) {
-      big_arr_.reserve(0);
+      : Deque(other, alloc_traits::select_on_container_copy_construction(
+                         other.alloc_)) {}
+
+  Deque(const Deque& other, const Allocator& alloc) : alloc_(alloc) {
+    if (other.empty()) {
       return;
     }
-    assign_arr(begin_.index_ + middle_, end_.index_ + 1 + middle_);
-    begin_.curr_ = big_arr_[middle_ + begin_.index_];
-    end_.curr_ = big_arr_[middle_ + end_.index_] + (now_sz_ - 1) % kSize;
-    ++end_;
-    filling_in_copy(other.begin_);
-  }
-
-  Deque(Deque&& other)
-      : now_sz_(other.now_sz_),
-        alloc_(
-            alloc_traits::select_on_container_copy_construction(other.alloc_)),
-        big_arr_(other.big_arr_),
-        node_(other.node_),
-        middle_(other.middle_),
-        begin_(other.begin_),
-        end_(other.end_) {
-    begin_.ptr_arr_ = &big_arr_;
-    begin_.middle_ = &middle_;
-    end_.ptr_arr_ = &big_arr_;
-    end_.middle_ = &middle_;
-    other.big_arr_.clear();
-    other.middle_ = 0;
-    other.begin_ = iterator();
-    other.end_ = iterator();
-    other.node_ = 0;
-    other.now_sz_ = 0;
+    create_storage(other.now_sz_);
+    construct_copy(other.cbegin());
+  }
+
+  // Забирает память other целиком, элементы не трогает. Итераторы other
+  // после этого недействительны, сам other - пустой дек без памяти.
+  Deque(Deque&& other) noexcept : alloc_(std::move(other.alloc_)) {
+    steal_storage(other);
   }
 
   Deque(std::initializer_list<T> init, const Allocator& alloc = Allocator())
-      : Deque(init.size(), alloc) {
-    for (iterator iter = begin_; iter != end_; ++iter) {
-      alloc_traits::destroy(alloc_, iter.curr_);
-    }
-    if (empty()) {
-      big_arr_.reserve(0);
+      : alloc_(alloc) {
+    if (init.size() == 0) {
       return;
     }
-    iterator iter = begin_;
-    for (auto iter_2 = init.begin(); iter_2 != init.end(); ++iter_2, ++iter) {
-      try {
-        alloc_traits::construct(alloc_, iter.curr_, *(iter_2));
-      } catch (...) {
-        for (iterator iter_del = iter; iter_del - begin_ > 0; --iter_del) {
-          alloc_traits::destroy(alloc_, iter_del.curr_);
-        }
-        for (int64_t counter = 0; counter < end_.index_ - begin_.index_ + 1;
-             ++counter) {
-          alloc_traits::deallocate(
-              alloc_, big_arr_[middle_ + begin_.index_ + counter], kSize);
-        }
-        throw;
-      }
-    }
+    create_storage(init.size());
+    construct_copy(init.begin());
   }
 
-  ~Deque() {
-    if (!big_arr_.empty()) {
-      bool statement = (end_.curr_ - big_arr_[middle_ + end_.index_] == 0);
-      for (iterator iter = begin_; iter != end_; ++iter) {
-        alloc_traits::destroy(alloc_, iter.curr_);
-      }
-      if (statement) {
-        --end_;
-      }
-      for (int64_t counter = 0; counter < end_.index_ - begin_.index_ + 1;
-           ++counter) {
-        alloc_traits::deallocate(
-            alloc_, big_arr_[middle_ + begin_.index_ + counter], kSize);
-      }
-    }
-  }
+  ~Deque() { destroy_storage(); }
 
+  // Копия строится на том аллокаторе, который будет у *this. Если аллокатор
+  // переходит от other, старые блоки и кэш возвращаются старому аллокатору
+  // до его замены.
   Deque& operator=(const Deque& other) {
-    if (alloc_traits::propagate_on_container_copy_assignment::value &&
-        alloc_ != other.alloc_) {
+    if (this == &other) {
+      return *this;
+    }
+    bool propagate =
+        alloc_traits::propagate_on_container_copy_assignment::value &&
+        alloc_ != other.alloc_;
+    Deque copy(other, propagate ? other.alloc_ : alloc_);
+    if (propagate) {
+      destroy_storage();
+      cache_.reset(other.alloc_);
       alloc_ = other.alloc_;
+      steal_storage(copy);
+    } else {
+      big_swap(copy, *this);
     }
-    Deque copy(other);
-    big_swap(copy, *this);
     return *this;
   }
 
-  Deque& operator=(Deque&& other) {
-    Deque copy = std::move(other);
-    if (alloc_traits::propagate_on_container_copy_assignment::value &&
-        alloc_ != other.alloc_) {
-      alloc_ = other.alloc_;
+  // Если аллокатор переходит вместе с памятью или аллокаторы равны, память
+  // other забирается целиком. Иначе чужие блоки взять нельзя, и элементы
+  // переносятся по одному.
+  Deque& operator=(Deque&& other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value) {
+    if (this == &other) {
+      return *this;
+    }
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                      value) {
+      destroy_storage();
+      if (alloc_ != other.alloc_) {
+        cache_.reset(other.alloc_);
+      }
+      alloc_ = std::move(other.alloc_);
+      steal_storage(other);
+    } else if (alloc_ == other.alloc_) {
+      destroy_storage();
+      steal_storage(other);
+    } else {
+      assign(std::make_move_iterator(other.begin()),
+             std::make_move_iterator(other.end()));
+      other.clear();
     }
-    big_swap(copy, *this);
     return *this;
   }
 
+  // Обменивает содержимое за O(1). Аллокаторы обмениваются, только если
+  // этого требует propagate_on_container_swap; иначе они должны быть равны.
+  void swap(Deque& other) noexcept {
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+      if (alloc_ != other.alloc_) {
+        cache_.reset(other.alloc_);
+        other.cache_.reset(alloc_);
+        using std::swap;
+        swap(alloc_, other.alloc_);
+      }
+    }
+    big_swap(*this, other);
+  }
+
+  friend void swap(Deque& first, Deque& second) noexcept {
+    first.swap(second);
+  }
+
   size_t size() const { return now_sz_; }
 
   bool empty() const { return now_sz_ == 0; }
@@ -199,363 +266,790 @@ class Deque {
     return *(begin_ + ind);
   }
 
-  void push_back(const T& value) {
-    if (empty()) {
-      Deque mine(1);
-      alloc_traits::destroy(alloc_, mine.begin_.curr_);
-      *this = mine;
-      alloc_traits::construct(alloc_, begin_.curr_, value);
-      return;
-    }
-    add_back(*this, value);
-  }
+  void push_back(const T& value) { emplace_back(value); }
 
-  void push_front(const T& value) {
-    if (empty()) {
-      Deque mine(1);
-      alloc_traits::destroy(alloc_, mine.begin_.curr_);
-      *this = mine;
-      alloc_traits::construct(alloc_, begin_.curr_, value);
-      return;
-    }
-    add_front(*this, value);
-  }
+  void push_front(const T& value) { emplace_front(value); }
 
-  void push_back(T&& value) {
-    if (empty()) {
-      Deque mine(1);
-      alloc_traits::destroy(alloc_, mine.begin_.curr_);
-      *this = std::move(mine);
-      alloc_traits::construct(alloc_, begin_.curr_, std::move(value));
-      return;
-    }
-    add_back(*this, std::move(value));
-  }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
 
-  void push_front(T&& value) {
-    if (empty()) {
-      Deque mine(1);
-      alloc_traits::destroy(alloc_, mine.begin_.curr_);
-      *this = std::move(mine);
-      alloc_traits::construct(alloc_, begin_.curr_, std::move(value));
-      return;
-    }
-    add_front(*this, std::move(value));
-  }
+  void push_front(T&& value) { emplace_front(std::move(value)); }
 
   void pop_back() {
+    bool first_in_block = (end_.curr_ == end_.first_);
     --end_;
     alloc_traits::destroy(alloc_, end_.curr_);
-    if (end_.curr_ - big_arr_[middle_ + end_.index_] == 0) {
-      alloc_traits::deallocate(alloc_, big_arr_[middle_ + end_.index_], kSize);
+    if (first_in_block) {
+      deallocate_block(block_at(end_.index_ + 1));
     }
     --now_sz_;
   }
 
   void pop_front() {
     alloc_traits::destroy(alloc_, begin_.curr_);
-    if (begin_.curr_ - big_arr_[middle_ + begin_.index_] == kSize - 1) {
-      alloc_traits::deallocate(alloc_, big_arr_[middle_ + begin_.index_],
-                               kSize);
-    }
+    bool last_in_block = (begin_.curr_ + 1 == begin_.last_);
     ++begin_;
+    if (last_in_block) {
+      deallocate_block(block_at(begin_.index_ - 1));
+    }
     --now_sz_;
   }
 
-  void insert(iterator iter, const T& value) {
-    if (big_arr_.empty()) {
-      Deque mine(1);
-      alloc_traits::destroy(alloc_, mine.begin_.curr_);
-      *this = mine;
-      alloc_traits::construct(alloc_, begin_.curr_, std::move(value));
-      return;
-    }
-    if (end_.curr_ - big_arr_[middle_ + end_.index_] == kSize - 1) {
-      if (end_.index_ == middle_) {
-        realloc();
-      }
-      big_arr_[middle_ + end_.index_ + 1] =
-          alloc_traits::allocate(alloc_, kSize);
-    }
-    for (iterator iter_2 = end_; iter_2 > iter; --iter_2) {
-      *iter_2 = *(iter_2 - 1);
+  iterator insert(iterator iter, const T& value) {
+    return emplace(iter, value);
+  }
+
+  iterator insert(iterator iter, T&& value) {
+    return emplace(iter, std::move(value));
+  }
+
+  // Сдвигает к iter ту часть дека, что короче, и освобождает крайний
+  // элемент с её стороны.
+  iterator erase(iterator iter) {
+    int64_t offset = iter - begin_;
+    if (offset < static_cast<int64_t>(now_sz_) - offset - 1) {
+      move_segments_backward(begin_, iter, iter + 1);
+      pop_front();
+    } else {
+      move_segments(iter + 1, end_, iter);
+      pop_back();
     }
-    alloc_traits::construct(alloc_, iter.curr_, value);
-    ++end_;
-    ++now_sz_;
+    return begin_ + offset;
   }
 
-  void erase(iterator iter) {
-    alloc_traits::destroy(alloc_, iter.curr_);
-    iterator iter_fir = iter;
-    iterator iter_sec = ++iter;
-    for (; iter_sec != end_; ++iter_fir, ++iter_sec) {
-      *iter_fir = *iter_sec;
+  // Удаляет [first, last) за один проход: меньшая из частей по краям
+  // сдвигается на место удалённых, освободившийся край уничтожается вместе
+  // с ненужными блоками.
+  iterator erase(iterator first, iterator last) {
+    int64_t count = last - first;
+    int64_t before = first - begin_;
+    if (count == 0) {
+      return first;
     }
-    if (end_.curr_ - big_arr_[middle_ + end_.index_] == 0) {
-      alloc_traits::deallocate(alloc_, big_arr_[middle_ + end_.index_], kSize);
+    if (before < end_ - last) {
+      move_segments_backward(begin_, first, last);
+      destroy_front(count);
+    } else {
+      move_segments(last, end_, first);
+      destroy_back(count);
     }
-    --end_;
-    alloc_traits::destroy(alloc_, end_.curr_);
-    --now_sz_;
+    return begin_ + before;
   }
 
   template <typename... Args>
   void emplace_back(Args&&... args) {
-    if (empty()) {
-      Deque mine(1);
-      alloc_traits::destroy(alloc_, mine.begin_.curr_);
-      *this = std::move(mine);
-      alloc_traits::construct(alloc_, begin_.curr_,
-                              std::forward<Args>(args)...);
-      return;
+    if (big_arr_.empty()) {
+      init_storage();
     }
-    add_back(*this, std::forward<Args>(args)...);
+    add_back(std::forward<Args>(args)...);
   }
 
   template <typename... Args>
   void emplace_front(Args&&... args) {
-    if (empty()) {
-      Deque mine(1);
-      alloc_traits::destroy(alloc_, mine.begin_.curr_);
-      *this = std::move(mine);
-      alloc_traits::construct(alloc_, begin_.curr_,
-                              std::forward<Args>(args)...);
-      return;
+    if (big_arr_.empty()) {
+      init_storage();
     }
-    add_front(*this, std::forward<Args>(args)...);
+    add_front(std::forward<Args>(args)...);
   }
 
+  // Освобождает место под новый элемент, сдвигая на одну позицию ту часть
+  // дека, что короче: начало влево или конец вправо.
   template <typename... Args>
-  void emplace(iterator iter, Args&&... args) {
-    if (empty()) {
-      Deque mine(1);
-      alloc_traits::destroy(alloc_, mine.begin_.curr_);
-      *this = std::move(mine);
-      alloc_traits::construct(alloc_, begin_.curr_,
-                              std::forward<Args>(args)...);
-      return;
+  iterator emplace(iterator iter, Args&&... args) {
+    int64_t offset = iter - begin_;
+    int64_t after = static_cast<int64_t>(now_sz_) - offset;
+    if (after == 0) {
+      emplace_back(std::forward<Args>(args)...);
+      return end_ - 1;
+    }
+    if (offset == 0) {
+      emplace_front(std::forward<Args>(args)...);
+      return begin_;
     }
-    if (end_.curr_ - big_arr_[middle_ + end_.index_] == kSize - 1) {
-      if (end_.index_ == middle_) {
-        realloc();
+    T value(std::forward<Args>(args)...);
+    if (offset < after) {
+      add_front(std::move(*begin_));
+      iterator pos = begin_ + offset;
+      move_segments(begin_ + 2, pos + 1, begin_ + 1);
+      *pos = std::move(value);
+      return pos;
+    }
+    add_back(std::move(*(end_ - 1)));
+    iterator pos = begin_ + offset;
+    move_segments_backward(pos, end_ - 2, end_ - 1);
+    *pos = std::move(value);
+    return pos;
+  }
+
+  // Вставляет копии [first, last) перед pos. Новые элементы дописываются
+  // к ближайшему краю и поворачиваются на место, так что сдвигается только
+  // меньшая часть дека.
+  template <std::input_iterator Iter>
+  iterator insert(iterator pos, Iter first, Iter last) {
+    int64_t offset = pos - begin_;
+    if constexpr (std::forward_iterator<Iter>) {
+      insert_n(offset, first, std::distance(first, last));
+    } else {
+      Deque buffer(alloc_);
+      buffer.append_range(std::ranges::subrange(first, last));
+      insert_n(offset, std::make_move_iterator(buffer.begin()), buffer.size());
+    }
+    return begin_ + offset;
+  }
+
+  // Добавляет элементы range в конец. Блоки под них выделяются заранее,
+  // а заполняются кусками по блоку (memcpy, если T тривиально копируемый).
+  template <std::ranges::input_range Range>
+  void append_range(Range&& range) {
+    if constexpr (std::ranges::forward_range<Range>) {
+      append_n(std::ranges::begin(range), std::ranges::distance(range));
+    } else {
+      for (auto&& value : range) {
+        emplace_back(std::forward<decltype(value)>(value));
       }
-      big_arr_[middle_ + end_.index_ + 1] =
-          alloc_traits::allocate(alloc_, kSize);
     }
-    for (iterator iter_2 = end_; iter_2 > iter; --iter_2) {
-      *iter_2 = *(iter_2 - 1);
+  }
+
+  // Добавляет элементы range в начало, сохраняя их порядок.
+  template <std::ranges::input_range Range>
+  void prepend_range(Range&& range) {
+    if constexpr (std::ranges::forward_range<Range>) {
+      prepend_n(std::ranges::begin(range), std::ranges::distance(range));
+    } else {
+      Deque buffer(alloc_);
+      buffer.append_range(std::forward<Range>(range));
+      prepend_n(std::make_move_iterator(buffer.begin()), buffer.size());
     }
-    alloc_traits::construct(alloc_, iter.curr_, std::forward<Args>(args)...);
-    ++end_;
-    ++now_sz_;
+  }
+
+  template <std::input_iterator Iter>
+  void assign(Iter first, Iter last) {
+    clear();
+    append_range(std::ranges::subrange(first, last));
+  }
+
+  void assign(size_t count, const T& value) {
+    clear();
+    for (size_t ind = 0; ind < count; ++ind) {
+      emplace_back(value);
+    }
+  }
+
+  void assign(std::initializer_list<T> init) {
+    clear();
+    append_range(init);
+  }
+
+  // Уничтожает все элементы. Как и опустошённый pop'ами дек, сохраняет
+  // карту и один блок, чтобы следующее заполнение не ходило в аллокатор.
+  void clear() {
+    if (big_arr_.empty()) {
+      return;
+    }
+    destroy_range(begin_, now_sz_);
+    for (int64_t index = begin_.index_ + 1; index <= end_.index_; ++index) {
+      deallocate_block(block_at(index));
+    }
+    begin_ = iterator(&big_arr_, begin_.index_,
+                      block_at(begin_.index_) + kSize / 2, &middle_);
+    end_ = begin_;
+    now_sz_ = 0;
   }
 
   iterator begin() { return begin_; }
 
   iterator end() { return end_; }
 
-  const_iterator cbegin() const {
-    const_iterator const_begin(begin_.ptr_arr_, begin_.index_, begin_.curr_,
-                               begin_.middle_);
-    return const_begin;
+  // Отдаёт аллокатору свободную часть карты и запасные блоки своего кэша.
+  // Пустой дек освобождает всю память.
+  void shrink_to_fit() {
+    if (now_sz_ == 0 && !big_arr_.empty()) {
+      destroy_storage();
+      big_arr_ = std::vector<T*>();
+      node_ = 0;
+      middle_ = 0;
+      begin_ = iterator();
+      end_ = iterator();
+    } else if (now_sz_ != 0 && end_.index_ - begin_.index_ + 1 < node_) {
+      std::vector<T*> fitted(big_arr_.begin() + (middle_ + begin_.index_),
+                             big_arr_.begin() + (middle_ + end_.index_ + 1));
+      big_arr_ = std::move(fitted);
+      node_ = big_arr_.size();
+      middle_ = -begin_.index_;
+    }
+    cache_.release();
   }
 
-  const_iterator cend() const {
-    const_iterator const_end(end_.ptr_arr_, end_.index_, end_.curr_,
-                             end_.middle_);
-    return const_end;
-  }
+  const_iterator begin() const { return begin_; }
+
+  const_iterator end() const { return end_; }
+
+  const_iterator cbegin() const { return begin_; }
+
+  const_iterator cend() const { return end_; }
 
   const_reverse_iterator rbegin() const {
-    const_iterator const_end(end_.ptr_arr_, end_.index_, end_.curr_,
-                             end_.middle_);
-    return std::make_reverse_iterator(const_end);
+    return std::make_reverse_iterator(cend());
   }
 
   const_reverse_iterator rend() const {
-    const_iterator const_begin(begin_.ptr_arr_, begin_.index_, begin_.curr_,
-                               begin_.middle_);
-    return std::make_reverse_iterator(const_begin);
+    return std::make_reverse_iterator(cbegin());
   }
 
   reverse_iterator rbegin() { return std::make_reverse_iterator(end_); }
 
   reverse_iterator rend() { return std::make_reverse_iterator(begin_); }
 
-  const_reverse_iterator crbegin() const {
-    const_iterator const_end(end_.ptr_arr_, end_.index_, end_.curr_,
-                             end_.middle_);
-    return std::make_reverse_iterator(const_end);
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  const_reverse_iterator crend() const { return rend(); }
+
+  // Вызывает func(std::span<T>) для каждого непрерывного куска элементов по
+  // порядку: циклы по блокам компилятор векторизует, в отличие от обхода
+  // итератором.
+  template <typename Func>
+  void for_each_segment(Func func) {
+    for_each_block([&func](T* first, T* last) {
+      func(std::span<T>(first, last));
+    });
   }
 
-  const_reverse_iterator crend() const {
-    const_iterator const_begin(begin_.ptr_arr_, begin_.index_, begin_.curr_,
-                               begin_.middle_);
-    return make_reverse_iterator(const_begin);
+  template <typename Func>
+  void for_each_segment(Func func) const {
+    for_each_block([&func](const T* first, const T* last) {
+      func(std::span<const T>(first, last));
+    });
   }
 
   const allocator_type& get_allocator() const { return alloc_; }
 
+  // Подключает кэш блоков, общий для нескольких деков этого типа. Блоки
+  // переходят между деками, поэтому это допустимо только для аллокаторов,
+  // все экземпляры которых равны. Кэш не потокобезопасен: все деки, которые
+  // его делят, изменяются и уничтожаются в одном потоке (или под общей
+  // блокировкой), в том числе после перемещения.
+  void share_block_cache(std::shared_ptr<block_cache> cache)
+    requires alloc_traits::is_always_equal::value
+  {
+    cache_.release();
+    shared_cache_ = std::move(cache);
+  }
+
+  size_t block_cache_hits() const {
+    return shared_cache_ ? shared_cache_->hits() : cache_.hits();
+  }
+
+  size_t block_cache_misses() const {
+    return shared_cache_ ? shared_cache_->misses() : cache_.misses();
+  }
+
  private:
+  // Блоки с индексами от begin_.index_ до end_.index_ включительно всегда
+  // выделены (в том числе блок, на который указывает end_), остальные
+  // ячейки big_arr_ равны nullptr. Пустой дек без памяти имеет пустой
+  // big_arr_.
   int64_t node_ = 0;  // количество маленьких массивов(для удобства)
   std::vector<T*> big_arr_;  // большой вектор массивов
-  int64_t middle_;  // хранит индекс середины большого массива(нужна для
-                    // аллокации после пушей)
+  int64_t middle_ = 0;  // хранит индекс середины большого массива(нужна для
+                        // аллокации после пушей)
   iterator begin_;  // итератор на начало дека
   iterator end_;  // итератор на следующую ячейку после последней в деке
-  static const int64_t kSize = 32;  // размер маленького массивчика
-  size_t now_sz_ = 0;               // текущий размер дека
+  static constexpr int64_t kSize = kBlockSize;  // размер маленького массивчика
+  static constexpr int kShift = std::countr_zero(kBlockSize);  // log2(kSize)
+  size_t now_sz_ = 0;  // текущий размер дека
 
   allocator_type alloc_;  //мой аллокатор
+  block_cache cache_{alloc_};  // свои запасные блоки
+  std::shared_ptr<block_cache> shared_cache_;  // общий кэш, если подключён
+
+  // Элементы можно создавать memcpy: T тривиально копируемый, а аллокатор
+  // не переопределяет construct.
+  static constexpr bool kMemcpyConstruct =
+      std::is_trivially_copyable_v<T> &&
+      !requires(Allocator& alloc, T* place, const T& value) {
+        alloc.construct(place, value);
+      };
+
+  // Элементы можно уничтожать, ничего не вызывая.
+  static constexpr bool kTrivialDestroy =
+      std::is_trivially_destructible_v<T> &&
+      !requires(Allocator& alloc, T* place) { alloc.destroy(place); };
+
+  // Сдвиги внутри дека делаются memmove вместо поэлементного присваивания.
+  static constexpr bool kMemmoveShift = std::is_trivially_copyable_v<T>;
+
+  template <typename Iter>
+  static constexpr bool kIsDequeIterator =
+      std::is_same_v<Iter, iterator> || std::is_same_v<Iter, const_iterator>;
+
+  block_cache& active_cache() {
+    return shared_cache_ ? *shared_cache_ : cache_;
+  }
+
+  T*& block_at(int64_t index) { return big_arr_[middle_ + index]; }
+
+  T* block_at(int64_t index) const { return big_arr_[middle_ + index]; }
+
+  template <typename Func>
+  void for_each_block(Func func) const {
+    if (now_sz_ == 0) {
+      return;
+    }
+    for (int64_t index = begin_.index_; index <= end_.index_; ++index) {
+      T* first = index == begin_.index_ ? begin_.curr_ : block_at(index);
+      T* last = index == end_.index_ ? end_.curr_ : block_at(index) + kSize;
+      if (first != last) {
+        func(first, last);
+      }
+    }
+  }
+
+  T* allocate_block() { return active_cache().allocate(); }
+
+  void deallocate_block(T*& block) {
+    active_cache().deallocate(block);
+    block = nullptr;
+  }
 
   void assign_arr(int64_t start, int64_t finish) {
     for (int64_t ind = start; ind < finish; ++ind) {
       try {
-        big_arr_[ind] = alloc_traits::allocate(alloc_, kSize);
+        big_arr_[ind] = allocate_block();
       } catch (...) {
-        for (int64_t ret_ind = 0; ret_ind < ind; ++ret_ind) {
-          alloc_traits::deallocate(alloc_, big_arr_[ret_ind], kSize);
+        for (int64_t ret_ind = start; ret_ind < ind; ++ret_ind) {
+          deallocate_block(big_arr_[ret_ind]);
         }
         throw;
       }
     }
   }
 
-  void filling() {
-    if constexpr (std::is_default_constructible<T>::value) {
-      for (iterator iter = begin_; iter != end_; ++iter) {
-        try {
-          alloc_traits::construct(alloc_, iter.curr_);
-        } catch (...) {
-          for (iterator ret_it = begin_; ret_it != iter; ++ret_it) {
-            alloc_traits::destroy(alloc_, iter.curr_);
-          }
-          for (int64_t ret_ind = 0; ret_ind < node_; ++ret_ind) {
-            alloc_traits::deallocate(alloc_, big_arr_[ret_ind], kSize);
-          }
-          throw;
+  // Выделяет карту и блоки под count элементов, не создавая их.
+  void create_storage(size_t count) {
+    node_ = count / kSize + 1;
+    middle_ = node_ / 2;
+    big_arr_.assign(node_, nullptr);
+    assign_arr(0, node_);
+    begin_ = iterator(&big_arr_, -middle_, big_arr_[0], &middle_);
+    end_ = iterator(&big_arr_, node_ - 1 - middle_,
+                    big_arr_[node_ - 1] + count % kSize, &middle_);
+    now_sz_ = count;
+  }
+
+  // Память под первый элемент пустого дека: карта из одного блока, начало и
+  // конец в середине блока, чтобы и push_back, и push_front поначалу
+  // обходились без нового блока. Опустевший дек сохраняет свой последний
+  // блок и карту, так что сюда попадает только дек, у которого их нет.
+  void init_storage() {
+    T* block = allocate_block();
+    try {
+      big_arr_.assign(1, block);
+    } catch (...) {
+      deallocate_block(block);
+      throw;
+    }
+    node_ = 1;
+    middle_ = 0;
+    begin_ = iterator(&big_arr_, 0, block + kSize / 2, &middle_);
+    end_ = begin_;
+  }
+
+  // Создаёт в памяти, выделенной create_storage, копии now_sz_ элементов
+  // начиная с source; при исключении освобождает блоки.
+  template <typename Iter>
+  void construct_copy(Iter source) {
+    try {
+      construct_segments(begin_, source, now_sz_);
+    } catch (...) {
+      for (int64_t index = begin_.index_; index <= end_.index_; ++index) {
+        deallocate_block(block_at(index));
+      }
+      throw;
+    }
+  }
+
+  // Создаёт count элементов с места dest из [source, source + count)
+  // кусками, не пересекающими границ блоков (ни своих, ни блоков
+  // дека-источника). Если конструктор бросает, созданное уничтожается.
+  template <typename Iter>
+  void construct_segments(iterator dest, Iter source, size_t count) {
+    iterator start = dest;
+    size_t done = 0;
+    try {
+      while (done < count) {
+        size_t chunk = std::min<size_t>(count - done,
+                                        kSize - (dest.curr_ - dest.block()));
+        if constexpr (kIsDequeIterator<Iter>) {
+          chunk = std::min<size_t>(chunk,
+                                   kSize - (source.curr_ - source.block()));
+          const T* first = source.curr_;
+          construct_chunk(dest.curr_, first, chunk, done);
+          source += chunk;
+        } else {
+          construct_chunk(dest.curr_, source, chunk, done);
         }
+        dest += chunk;
+      }
+    } catch (...) {
+      for (; done > 0; --done, ++start) {
+        alloc_traits::destroy(alloc_, start.curr_);
+      }
+      throw;
+    }
+  }
+
+  // Создаёт count элементов подряд с места place, сдвигая source; done
+  // считает созданные, чтобы вызывающий мог откатиться.
+  template <typename Iter>
+  void construct_chunk(T* place, Iter& source, size_t count, size_t& done) {
+    if constexpr (kMemcpyConstruct && std::contiguous_iterator<Iter> &&
+                  std::is_same_v<std::iter_value_t<Iter>, T>) {
+      std::memcpy(place, std::to_address(source), count * sizeof(T));
+      source += count;
+      done += count;
+    } else {
+      for (size_t ind = 0; ind < count; ++ind, ++source, ++done) {
+        alloc_traits::construct(alloc_, place + ind, *source);
       }
     }
   }
 
-  void filling_in_copy(const iterator& it_begin) {
-    iterator iter = it_begin;
-    for (iterator iter_2 = begin_; iter_2 != end_; ++iter_2, ++iter) {
+  // Гарантирует, что в карте есть место под блоки [first, last], и
+  // выделяет те из них, которых ещё нет. Если выделить не удалось,
+  // возвращает уже выделенные.
+  void reserve_blocks(int64_t first, int64_t last) {
+    if (first > last) {
+      return;
+    }
+    if (middle_ + first < 0 || middle_ + last >= node_) {
+      realloc(std::min(first, begin_.index_), std::max(last, end_.index_));
+    }
+    for (int64_t index = first; index <= last; ++index) {
+      if (block_at(index) != nullptr) {
+        continue;
+      }
       try {
-        alloc_traits::construct(alloc_, iter_2.curr_, *iter);
+        block_at(index) = allocate_block();
       } catch (...) {
-        for (iterator iter_del = iter_2; iter_del - begin_ > 0; --iter_del) {
-          alloc_traits::destroy(alloc_, iter_del.curr_);
-        }
-        for (int64_t counter = 0; counter < end_.index_ - begin_.index_ + 1;
-             ++counter) {
-          alloc_traits::deallocate(
-              alloc_, big_arr_[middle_ + begin_.index_ + counter], kSize);
-        }
+        release_blocks(first, last);
         throw;
       }
     }
   }
 
-  void big_swap(Deque& first, Deque& second) {
+  // Освобождает блоки из [first, last], не занятые элементами дека.
+  void release_blocks(int64_t first, int64_t last) {
+    for (int64_t index = first; index <= last; ++index) {
+      if ((index < begin_.index_ || index > end_.index_) &&
+          block_at(index) != nullptr) {
+        deallocate_block(block_at(index));
+      }
+    }
+  }
+
+  template <typename Iter>
+  void append_n(Iter source, size_t count) {
+    if (count == 0) {
+      return;
+    }
+    if (big_arr_.empty()) {
+      init_storage();
+    }
+    int64_t offset =
+        (end_.curr_ - block_at(end_.index_)) + static_cast<int64_t>(count);
+    int64_t last = end_.index_ + (offset >> kShift);
+    reserve_blocks(end_.index_ + 1, last);
+    try {
+      construct_segments(end_, source, count);
+    } catch (...) {
+      release_blocks(end_.index_ + 1, last);
+      throw;
+    }
+    end_ += count;
+    now_sz_ += count;
+  }
+
+  template <typename Iter>
+  void prepend_n(Iter source, size_t count) {
+    if (count == 0) {
+      return;
+    }
+    if (big_arr_.empty()) {
+      init_storage();
+    }
+    int64_t offset = (begin_.curr_ - block_at(begin_.index_)) -
+                     static_cast<int64_t>(count);
+    int64_t first = begin_.index_ + (offset >> kShift);
+    reserve_blocks(first, begin_.index_ - 1);
+    iterator place = begin_ - count;
+    try {
+      construct_segments(place, source, count);
+    } catch (...) {
+      release_blocks(first, begin_.index_ - 1);
+      throw;
+    }
+    begin_ = place;
+    now_sz_ += count;
+  }
+
+  template <typename Iter>
+  void insert_n(int64_t offset, Iter source, size_t count) {
+    int64_t before = offset;
+    int64_t after = now_sz_ - offset;
+    if (before < after) {
+      prepend_n(source, count);
+      std::rotate(begin_, begin_ + count, begin_ + (count + before));
+    } else {
+      append_n(source, count);
+      std::rotate(begin_ + before, begin_ + (before + after), end_);
+    }
+  }
+
+  // Перемещает [first, first + count) в [dest, dest + count), dest левее
+  // first. Куски не пересекают границ блоков ни источника, ни приёмника.
+  void move_segments(iterator first, iterator last, iterator dest) {
+    for (int64_t count = last - first; count > 0;) {
+      int64_t chunk = std::min({count, kSize - (first.curr_ - first.block()),
+                                kSize - (dest.curr_ - dest.block())});
+      if constexpr (kMemmoveShift) {
+        std::memmove(dest.curr_, first.curr_, chunk * sizeof(T));
+      } else {
+        std::move(first.curr_, first.curr_ + chunk, dest.curr_);
+      }
+      first += chunk;
+      dest += chunk;
+      count -= chunk;
+    }
+  }
+
+  // То же, что move_segments, но [first, last) переезжает так, что
+  // кончается в d_last правее last; куски идут с конца.
+  void move_segments_backward(iterator first, iterator last, iterator d_last) {
+    for (int64_t count = last - first; count > 0;) {
+      T* src_end = chunk_end(last);
+      T* dest_end = chunk_end(d_last);
+      int64_t chunk = std::min(
+          {count, src_end - block_of(last, src_end),
+           dest_end - block_of(d_last, dest_end)});
+      if constexpr (kMemmoveShift) {
+        std::memmove(dest_end - chunk, src_end - chunk, chunk * sizeof(T));
+      } else {
+        std::move_backward(src_end - chunk, src_end, dest_end);
+      }
+      last -= chunk;
+      d_last -= chunk;
+      count -= chunk;
+    }
+  }
+
+  // Конец куска, стоящего непосредственно перед iter: если iter в начале
+  // блока, это конец предыдущего блока.
+  T* chunk_end(const iterator& iter) {
+    T* block = block_at(iter.index_);
+    return iter.curr_ == block ? block_at(iter.index_ - 1) + kSize
+                               : iter.curr_;
+  }
+
+  // Начало блока, в котором кончается кусок с концом end.
+  T* block_of(const iterator& iter, T* end) {
+    return end == iter.curr_ ? block_at(iter.index_)
+                             : block_at(iter.index_ - 1);
+  }
+
+  // Уничтожает count элементов начиная с first.
+  void destroy_range(iterator first, size_t count) {
+    if constexpr (!kTrivialDestroy) {
+      for (; count > 0; --count, ++first) {
+        alloc_traits::destroy(alloc_, first.curr_);
+      }
+    }
+  }
+
+  // Уничтожает count первых элементов и отдаёт опустевшие блоки.
+  void destroy_front(size_t count) {
+    iterator new_begin = begin_ + count;
+    destroy_range(begin_, count);
+    for (int64_t index = begin_.index_; index < new_begin.index_; ++index) {
+      deallocate_block(block_at(index));
+    }
+    begin_ = new_begin;
+    now_sz_ -= count;
+  }
+
+  // Уничтожает count последних элементов и отдаёт опустевшие блоки.
+  void destroy_back(size_t count) {
+    iterator new_end = end_ - count;
+    destroy_range(new_end, count);
+    for (int64_t index = new_end.index_ + 1; index <= end_.index_; ++index) {
+      deallocate_block(block_at(index));
+    }
+    end_ = new_end;
+    now_sz_ -= count;
+  }
+
+  // Создаёт элементы в [begin_, end_) вызовом make(место); если make
+  // бросает, уничтожает созданное, освобождает блоки и пробрасывает дальше.
+  template <typename Make>
+  void construct_all(Make make) {
+    iterator iter = begin_;
+    try {
+      for (; iter != end_; ++iter) {
+        make(iter.curr_);
+      }
+    } catch (...) {
+      for (iterator ret_it = begin_; ret_it != iter; ++ret_it) {
+        alloc_traits::destroy(alloc_, ret_it.curr_);
+      }
+      for (int64_t index = begin_.index_; index <= end_.index_; ++index) {
+        deallocate_block(block_at(index));
+      }
+      throw;
+    }
+  }
+
+  void destroy_storage() {
+    if (big_arr_.empty()) {
+      return;
+    }
+    destroy_range(begin_, now_sz_);
+    for (int64_t index = begin_.index_; index <= end_.index_; ++index) {
+      deallocate_block(block_at(index));
+    }
+  }
+
+  // Забирает память other, оставляя его пустым деком без памяти.
+  void steal_storage(Deque& other) noexcept {
+    big_arr_ = std::exchange(other.big_arr_, {});
+    node_ = std::exchange(other.node_, 0);
+    middle_ = std::exchange(other.middle_, 0);
+    begin_ = std::exchange(other.begin_, iterator());
+    end_ = std::exchange(other.end_, iterator());
+    now_sz_ = std::exchange(other.now_sz_, 0);
+    rebind_iterators();
+  }
+
+  void big_swap(Deque& first, Deque& second) noexcept {
     std::swap(second.big_arr_, first.big_arr_);
     std::swap(second.node_, first.node_);
     std::swap(second.middle_, first.middle_);
-    std::swap(second.begin_.curr_, first.begin_.curr_);
-    std::swap(second.begin_.index_, first.begin_.index_);
-    std::swap(second.begin_.middle_, first.begin_.middle_);
-    std::swap(second.end_.curr_, first.end_.curr_);
-    std::swap(second.end_.index_, first.end_.index_);
-    std::swap(second.end_.middle_, first.end_.middle_);
-    if (first.big_arr_.size() == 0) {
-      second.begin_.ptr_arr_ = &second.big_arr_;
-      second.end_.ptr_arr_ = &second.big_arr_;
-    }
-    second.begin_.middle_ = &second.middle_;
-    second.end_.middle_ = &second.middle_;
+    std::swap(second.begin_, first.begin_);
+    std::swap(second.end_, first.end_);
     std::swap(second.now_sz_, first.now_sz_);
+    first.rebind_iterators();
+    second.rebind_iterators();
+  }
+
+  void rebind_iterators() noexcept {
+    begin_.ptr_arr_ = &big_arr_;
+    begin_.middle_ = &middle_;
+    end_.ptr_arr_ = &big_arr_;
+    end_.middle_ = &middle_;
   }
 
-  void realloc() {
-    node_ = 3 * node_;
-    std::vector<T*> copy_arr(node_, nullptr);
-    int64_t copy_middle = ((node_) / 2);
-    for (int64_t ind = 0; ind <= end_.index_ - begin_.index_; ++ind) {
-      copy_arr[ind + copy_middle + begin_.index_] =
-          big_arr_[middle_ + begin_.index_ + ind];
+  // Освобождает место в карте под индексы [first, last]. Если они занимают
+  // не больше половины карты, живые блоки сдвигаются к её середине на месте
+  // (так очередь, уползающая в одну сторону, не раздувает карту). Иначе
+  // блоки переносятся в карту втрое большего размера (или под [first, last],
+  // если это больше), и [first, last] встаёт посередине.
+  void realloc(int64_t first, int64_t last) {
+    int64_t span = last - first + 1;
+    if (2 * span <= node_) {
+      recenter((node_ - span) / 2 - first);
+      return;
+    }
+    int64_t new_node = 3 * std::max(node_, span);
+    std::vector<T*> copy_arr(new_node, nullptr);
+    int64_t copy_middle = (new_node - span) / 2 - first;
+    for (int64_t index = begin_.index_; index <= end_.index_; ++index) {
+      copy_arr[copy_middle + index] = block_at(index);
     }
     big_arr_ = std::move(copy_arr);
+    node_ = new_node;
     middle_ = copy_middle;
   }
 
+  // Сдвигает живые блоки так, чтобы середина карты стала new_middle.
+  // Индексы блоков (и итераторы) при этом не меняются.
+  void recenter(int64_t new_middle) {
+    T** from = big_arr_.data() + middle_ + begin_.index_;
+    T** to = big_arr_.data() + new_middle + begin_.index_;
+    int64_t count = end_.index_ - begin_.index_ + 1;
+    std::memmove(to, from, count * sizeof(T*));
+    std::fill(big_arr_.data(), to, nullptr);
+    std::fill(to + count, big_arr_.data() + node_, nullptr);
+    middle_ = new_middle;
+  }
+
   template <typename... Args>
-  void add_front(Deque& deq, Args&&... args) {
-    if (deq.middle_ + deq.begin_.index_ == 0) {
-      realloc();
-    }
-    if (deq.begin_.curr_ - deq.big_arr_[deq.middle_ + deq.begin_.index_] == 0) {
-      --deq.begin_.index_;
-      deq.big_arr_[deq.middle_ + deq.begin_.index_] =
-          alloc_traits::allocate(alloc_, kSize);
-      deq.begin_.curr_ =
-          deq.big_arr_[deq.middle_ + deq.begin_.index_] + kSize - 1;
-    } else {
-      --deq.begin_;
+  void add_front(Args&&... args) {
+    bool first_in_block = (begin_.curr_ == begin_.first_);
+    if (first_in_block) {
+      if (middle_ + begin_.index_ == 0) {
+        realloc(begin_.index_ - 1, end_.index_);
+      }
+      block_at(begin_.index_ - 1) = allocate_block();
     }
+    iterator place = begin_;
+    --place;
     try {
-      alloc_traits::construct(alloc_, begin_.curr_,
-                              std::forward<Args>(args)...);
+      alloc_traits::construct(alloc_, place.curr_, std::forward<Args>(args)...);
     } catch (...) {
-      if (deq.begin_.curr_ - deq.big_arr_[deq.middle_ + deq.begin_.index_] ==
-          kSize - 1) {
-        alloc_traits::deallocate(
-            alloc_, deq.big_arr_[deq.middle_ + deq.end_.index_], kSize);
+      if (first_in_block) {
+        deallocate_block(block_at(begin_.index_ - 1));
       }
       throw;
     }
-    ++deq.now_sz_;
+    begin_ = place;
+    ++now_sz_;
   }
 
   template <typename... Args>
-  void add_back(Deque& deq, Args&&... args) {
-    if (deq.node_ - 1 == deq.end_.index_ + deq.middle_) {
-      realloc();
-    }
-    if (deq.end_.curr_ - deq.big_arr_[deq.middle_ + deq.end_.index_] == 0) {
-      deq.big_arr_[deq.middle_ + deq.end_.index_] =
-          alloc_traits::allocate(alloc_, kSize);
-      deq.end_.curr_ = deq.big_arr_[deq.middle_ + deq.end_.index_];
+  void add_back(Args&&... args) {
+    bool last_in_block = (end_.curr_ + 1 == end_.last_);
+    if (last_in_block) {
+      if (middle_ + end_.index_ + 1 == node_) {
+        realloc(begin_.index_, end_.index_ + 1);
+      }
+      block_at(end_.index_ + 1) = allocate_block();
     }
     try {
-      alloc_traits::construct(alloc_, deq.end_.curr_,
-                              std::forward<Args>(args)...);
+      alloc_traits::construct(alloc_, end_.curr_, std::forward<Args>(args)...);
     } catch (...) {
-      if (deq.end_.curr_ - deq.big_arr_[deq.middle_ + deq.end_.index_] == 0) {
-        alloc_traits::deallocate(
-            alloc_, deq.big_arr_[deq.middle_ + deq.end_.index_], kSize);
+      if (last_in_block) {
+        deallocate_block(block_at(end_.index_ + 1));
       }
       throw;
     }
-    ++deq.end_;
-    ++deq.now_sz_;
+    ++end_;
+    ++now_sz_;
   }
 };
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, size_t kBlockSize>
 template <bool IsConst>
-class Deque<T, Allocator>::common_iterator {
+class Deque<T, Allocator, kBlockSize>::common_iterator {
  private:
   friend class Deque;
+  template <bool>
+  friend class common_iterator;
+
   std::vector<T*>* ptr_arr_;  // указатель на большой массив(нужно для того,
                               // чтобы итераторы не инвалидировались)
   int64_t index_;  // индекс массивчика, где находиться curr_ относительно
                    // середины большого массива
   T* curr_;  // указатель на ячейку, на которую указывает итератор
+  T* first_;  // начало блока с curr_, чтобы не ходить за ним в карту
+  T* last_;   // конец этого блока
   int64_t* middle_;  // индекс середины большого
                      // массив
 
+  T* block() const { return first_; }
+
+  // Переходит в блок index_, беря его адрес из карты.
+  void load_block() {
+    first_ = (*ptr_arr_)[*middle_ + index_];
+    last_ = first_ + kSize;
+  }
+
  public:
   using type = std::conditional_t<IsConst, const T, T>;
   using iterator_category = std::random_access_iterator_tag;
@@ -565,39 +1059,40 @@ class Deque<T, Allocator>::common_iterator {
   using difference_type = int64_t;
 
   common_iterator()
-      : ptr_arr_(nullptr), index_(0), curr_(nullptr), middle_(nullptr) {}
+      : ptr_arr_(nullptr),
+        index_(0),
+        curr_(nullptr),
+        first_(nullptr),
+        last_(nullptr),
+        middle_(nullptr) {}
 
   common_iterator(std::vector<T*>* arr, int64_t index, T* curr, int64_t* middle)
-      : ptr_arr_(arr), index_(index), curr_(curr), middle_(middle) {}
+      : ptr_arr_(arr), index_(index), curr_(curr), middle_(middle) {
+    load_block();
+  }
 
-  common_iterator(const common_iterator& other)
+  // iterator неявно превращается в const_iterator.
+  template <bool OtherConst>
+    requires(IsConst && !OtherConst)
+  common_iterator(const common_iterator<OtherConst>& other)
       : ptr_arr_(other.ptr_arr_),
         index_(other.index_),
         curr_(other.curr_),
+        first_(other.first_),
+        last_(other.last_),
         middle_(other.middle_) {}
 
-  common_iterator& operator=(const common_iterator& other) {
-    ptr_arr_ = other.ptr_arr_;
-    curr_ = other.curr_;
-    index_ = other.index_;
-    middle_ = other.middle_;
-    return *this;
-  }
-
-  type& operator*() { return *curr_; }
+  type& operator*() const { return *curr_; }
 
-  const type& operator*() const { return *curr_; }
+  type* operator->() const { return curr_; }
 
-  type* operator->() { return curr_; }
-
-  const type* operator->() const { return curr_; }
+  type& operator[](int64_t num) const { return *(*this + num); }
 
   common_iterator& operator++() {
-    if (curr_ - (*ptr_arr_)[*middle_ + index_] == kSize - 1) {
+    if (++curr_ == last_) {
       ++index_;
-      curr_ = (*ptr_arr_)[*middle_ + index_];
-    } else {
-      ++curr_;
+      load_block();
+      curr_ = first_;
     }
     return *this;
   }
@@ -609,12 +1104,12 @@ class Deque<T, Allocator>::common_iterator {
   }
 
   common_iterator& operator--() {
-    if (curr_ - (*ptr_arr_)[*middle_ + index_] == 0) {
+    if (curr_ == first_) {
       --index_;
-      curr_ = (*ptr_arr_)[*middle_ + index_] + (kSize - 1);
-    } else {
-      --curr_;
+      load_block();
+      curr_ = last_;
     }
+    --curr_;
     return *this;
   }
 
@@ -624,14 +1119,18 @@ class Deque<T, Allocator>::common_iterator {
     return tmp;
   }
 
+  // Смещение от начала текущего блока делится на kSize сдвигом: для
+  // отрицательных смещений арифметический сдвиг округляет вниз, как нужно.
+  // В пределах блока карта не читается.
   common_iterator& operator+=(int64_t num) {
-    if (num == 0) {
+    int64_t offset = (curr_ - first_) + num;
+    if (offset >= 0 && offset < kSize) {
+      curr_ += num;
       return *this;
     }
-    int64_t helper = kSize - (curr_ - (*ptr_arr_)[*middle_ + index_]) - 1;
-    index_ += (num - helper + kSize - 1) / kSize;
-    curr_ = (*ptr_arr_)[*middle_ + index_] + num - helper -
-            kSize * ((num - helper + kSize - 1) / kSize - 1) - 1;
+    index_ += offset >> kShift;
+    load_block();
+    curr_ = first_ + (offset & (kSize - 1));
     return *this;
   }
 
@@ -641,18 +1140,12 @@ class Deque<T, Allocator>::common_iterator {
     return tmp;
   }
 
-  common_iterator& operator-=(int64_t num) {
-    if (num == 0) {
-      return *this;
-    }
-    int64_t helper = curr_ - (*ptr_arr_)[*middle_ + index_];
-    index_ -= (num - helper + kSize - 1) / kSize;
-    curr_ =
-        (*ptr_arr_)[*middle_ + index_] + kSize - 1 -
-        (num - helper - kSize * ((num - helper + kSize - 1) / kSize - 1) - 1);
-    return *this;
+  friend common_iterator operator+(int64_t num, const common_iterator& iter) {
+    return iter + num;
   }
 
+  common_iterator& operator-=(int64_t num) { return *this += -num; }
+
   common_iterator operator-(int64_t num) const {
     common_iterator tmp = *this;
     tmp -= num;
@@ -660,26 +1153,16 @@ class Deque<T, Allocator>::common_iterator {
   }
 
   int64_t operator-(const common_iterator& other) const {
-    if (ptr_arr_ == nullptr) {
-      return 0;
-    }
-    int64_t diff;
-    if (index_ != other.index_) {
-      if (index_ > other.index_) {
-        diff = kSize - (other.curr_ - (*ptr_arr_)[*middle_ + other.index_]) +
-               (curr_ - (*ptr_arr_)[*middle_ + index_]) +
-               kSize * (index_ - other.index_ - 1);
-      } else {
-        diff = -(other - *this);
-      }
-    } else {
-      diff = curr_ - other.curr_;
+    if (index_ == other.index_) {
+      return curr_ - other.curr_;
     }
-    return diff;
+    return ((index_ - other.index_) << kShift) + (curr_ - first_) -
+           (other.curr_ - other.first_);
   }
 
   bool operator<(const common_iterator& other) const {
-    return (*this - other) < 0;
+    return index_ != other.index_ ? index_ < other.index_
+                                  : curr_ < other.curr_;
   }
 
   bool operator>(const common_iterator& other) const { return other < *this; }
@@ -692,10 +1175,13 @@ class Deque<T, Allocator>::common_iterator {
     return !(*this < other);
   }
 
+  // curr_ всегда лежит внутри своего блока, поэтому разные позиции имеют
+  // разные указатели.
   bool operator==(const common_iterator& other) const {
-    return !(*this < other) && !(other < *this);
+    return curr_ == other.curr_;
   }
+
   bool operator!=(const common_iterator& other) const {
-    return !(*this == other);
+    return curr_ != other.curr_;
   }
 };
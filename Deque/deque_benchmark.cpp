@@ -0,0 +1,273 @@
+// Бенчмарки дека; результат - JSON, чтобы сравнивать прогоны между версиями.
+//
+//   deque_benchmark [--ops N] [--out file.json]
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../Benchmark/benchmark.hpp"
+#include "../Benchmark/heap_counter.hpp"
+#include "deque.hpp"
+
+namespace {
+
+BenchmarkRow Row(const std::string& name, const std::string& container,
+                 size_t batch) {
+  return BenchmarkRow()
+      .Add("name", name)
+      .Add("container", container)
+      .Add("batch", batch);
+}
+
+// Очередь опустошается и наполняется заново: batch раз push_back, затем
+// batch раз pop_front. Пустой дек не должен ходить в кучу на каждом цикле.
+template <typename Container>
+BenchmarkRow RunDrainRefill(const std::string& container, size_t batch,
+                            uint64_t cycles) {
+  Container queue;
+  HeapMeter meter;
+  for (uint64_t cycle = 0; cycle < cycles; ++cycle) {
+    for (size_t ind = 0; ind < batch; ++ind) {
+      queue.push_back(ind);
+    }
+    for (size_t ind = 0; ind < batch; ++ind) {
+      sink = *queue.begin();
+      queue.pop_front();
+    }
+  }
+  meter.Stop();
+  return meter.PerOp(Row("drain_refill", container, batch), cycles * batch);
+}
+
+// Очередь из backlog элементов, в которую push_back и pop_front идут по
+// очереди: живые блоки уползают вдоль карты, а карта не должна расти.
+template <typename Container>
+BenchmarkRow RunSteadyFifo(const std::string& container, size_t backlog,
+                           uint64_t ops) {
+  Container queue;
+  for (size_t ind = 0; ind < backlog; ++ind) {
+    queue.push_back(ind);
+  }
+  HeapMeter meter;
+  for (uint64_t ind = 0; ind < ops; ++ind) {
+    queue.push_back(ind);
+    sink = *queue.begin();
+    queue.pop_front();
+  }
+  meter.Stop();
+  return meter.PerOp(Row("steady_fifo", container, backlog), ops);
+}
+
+// Загрузка count записей из вектора: поэлементный push_back против
+// append_range, который заполняет блоки целиком.
+template <typename Container>
+BenchmarkRow RunBulkLoad(const std::string& name, const std::string& container,
+                         const std::vector<uint64_t>& records,
+                         uint64_t rounds) {
+  HeapMeter meter;
+  for (uint64_t round = 0; round < rounds; ++round) {
+    Container queue;
+    if constexpr (std::is_same_v<Container, Deque<uint64_t>>) {
+      if (name == "append_range") {
+        queue.append_range(records);
+      }
+    } else {
+      if (name == "append_range") {
+        queue.insert(queue.end(), records.begin(), records.end());
+      }
+    }
+    if (name == "push_back") {
+      for (uint64_t record : records) {
+        queue.push_back(record);
+      }
+    }
+    sink = *(queue.end() - 1);
+  }
+  meter.Stop();
+  return meter.PerOp(Row(name, container, records.size()),
+                     rounds * records.size());
+}
+
+// Вставка и удаление одного элемента на четверти длины дека: сдвигаться
+// должно начало, а не три четверти элементов до конца.
+template <typename Container>
+BenchmarkRow RunQuarterEdits(const std::string& container, size_t size,
+                             uint64_t rounds) {
+  Container queue;
+  for (size_t ind = 0; ind < size; ++ind) {
+    queue.push_back(ind);
+  }
+  HeapMeter meter;
+  for (uint64_t round = 0; round < rounds; ++round) {
+    queue.insert(queue.begin() + size / 4, round);
+    queue.erase(queue.begin() + size / 4);
+  }
+  meter.Stop();
+  sink = *queue.begin();
+  return meter.PerOp(Row("quarter_insert_erase", container, size), rounds);
+}
+
+// Дек из size элементов удаляется кусками по 64 с четверти длины.
+template <typename Container>
+BenchmarkRow RunRangeErase(const std::string& container, size_t size) {
+  Container queue;
+  for (size_t ind = 0; ind < size; ++ind) {
+    queue.push_back(ind);
+  }
+  HeapMeter meter;
+  while (queue.size() >= 64) {
+    auto first = queue.begin() + queue.size() / 4;
+    queue.erase(first, first + 64);
+  }
+  meter.Stop();
+  sink = queue.size();
+  return meter.PerOp(Row("range_erase_64", container, size),
+                     size - queue.size());
+}
+
+// Сумма size элементов: обход range-for (name == "range_for") или по
+// непрерывным кускам (name == "for_each_segment", только для Deque).
+template <typename Container>
+BenchmarkRow RunTraversal(const std::string& name, const std::string& container,
+                          size_t size, uint64_t rounds) {
+  Container queue;
+  for (size_t ind = 0; ind < size; ++ind) {
+    queue.push_back(ind);
+  }
+  HeapMeter meter;
+  for (uint64_t round = 0; round < rounds; ++round) {
+    uint64_t sum = 0;
+    if constexpr (std::is_same_v<Container, Deque<uint64_t>>) {
+      if (name == "for_each_segment") {
+        queue.for_each_segment([&sum](std::span<uint64_t> segment) {
+          uint64_t part = 0;
+          for (uint64_t value : segment) {
+            part += value;
+          }
+          sum += part;
+        });
+      }
+    }
+    if (name == "range_for") {
+      for (uint64_t value : queue) {
+        sum += value;
+      }
+    }
+    sink = sum;
+  }
+  meter.Stop();
+  return meter.PerOp(Row(name, container, size), rounds * size);
+}
+
+// Элемент, считающий свои копирования и перемещения.
+struct Tracked {
+  static inline uint64_t copies = 0;
+  static inline uint64_t moves = 0;
+
+  uint64_t value;
+
+  Tracked(uint64_t val) : value(val) {}
+  Tracked(const Tracked& other) : value(other.value) { ++copies; }
+  Tracked(Tracked&& other) noexcept : value(other.value) { ++moves; }
+  Tracked& operator=(const Tracked& other) {
+    value = other.value;
+    ++copies;
+    return *this;
+  }
+  Tracked& operator=(Tracked&& other) noexcept {
+    value = other.value;
+    ++moves;
+    return *this;
+  }
+};
+
+// В вектор добавляются count деков по 8 элементов. При переаллокации
+// вектор перемещает деки, только если их перемещение noexcept, иначе
+// копирует каждый элемент каждого дека.
+template <typename Container>
+BenchmarkRow RunVectorOfDeques(const std::string& container, size_t count) {
+  uint64_t copies = Tracked::copies + Tracked::moves;
+  HeapMeter meter;
+  {
+    std::vector<Container> deques;
+    for (size_t ind = 0; ind < count; ++ind) {
+      deques.emplace_back();
+      for (uint64_t value = 0; value < 8; ++value) {
+        deques.back().push_back(Tracked(value));
+      }
+    }
+    sink = deques.size();
+  }
+  meter.Stop();
+  // Перемещения при push_back неизбежны; всё сверх 8 на дек сделал вектор.
+  copies = Tracked::copies + Tracked::moves - copies - 8 * count;
+  return meter.PerOp(Row("vector_of_deques", container, count), count)
+      .Add("element_copies", copies);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkArgs args(argc, argv);
+  uint64_t ops = args.Number("--ops", 1'000'000);
+
+  std::vector<BenchmarkRow> results;
+  for (size_t batch : {1, 8, 64, 1024}) {
+    uint64_t cycles = std::max<uint64_t>(ops / batch, 1);
+    results.push_back(
+        RunDrainRefill<Deque<uint64_t>>("Deque", batch, cycles));
+    results.push_back(
+        RunDrainRefill<std::deque<uint64_t>>("std::deque", batch, cycles));
+  }
+
+  results.push_back(RunSteadyFifo<Deque<uint64_t>>("Deque", 1000, ops));
+  results.push_back(
+      RunSteadyFifo<std::deque<uint64_t>>("std::deque", 1000, ops));
+
+  std::vector<uint64_t> records(1'000'000);
+  for (size_t ind = 0; ind < records.size(); ++ind) {
+    records[ind] = ind;
+  }
+  uint64_t rounds = std::max<uint64_t>(ops / records.size(), 1);
+  for (const char* name : {"push_back", "append_range"}) {
+    results.push_back(
+        RunBulkLoad<Deque<uint64_t>>(name, "Deque", records, rounds));
+    results.push_back(
+        RunBulkLoad<std::deque<uint64_t>>(name, "std::deque", records, rounds));
+  }
+
+  const size_t edit_size = 100'000;
+  uint64_t edit_rounds = std::max<uint64_t>(ops / 100, 1);
+  results.push_back(
+      RunQuarterEdits<Deque<uint64_t>>("Deque", edit_size, edit_rounds));
+  results.push_back(RunQuarterEdits<std::deque<uint64_t>>(
+      "std::deque", edit_size, edit_rounds));
+  results.push_back(RunRangeErase<Deque<uint64_t>>("Deque", edit_size));
+  results.push_back(
+      RunRangeErase<std::deque<uint64_t>>("std::deque", edit_size));
+
+  const size_t walk_size = 100'000;
+  uint64_t walk_rounds = std::max<uint64_t>(ops / walk_size, 1);
+  results.push_back(RunTraversal<Deque<uint64_t>>("range_for", "Deque",
+                                                  walk_size, walk_rounds));
+  results.push_back(RunTraversal<Deque<uint64_t>>(
+      "for_each_segment", "Deque", walk_size, walk_rounds));
+  results.push_back(RunTraversal<std::deque<uint64_t>>(
+      "range_for", "std::deque", walk_size, walk_rounds));
+  results.push_back(RunTraversal<std::vector<uint64_t>>(
+      "range_for", "std::vector", walk_size, walk_rounds));
+
+  const size_t vector_size = 100'000;
+  results.push_back(
+      RunVectorOfDeques<Deque<Tracked>>("Deque", vector_size));
+  results.push_back(
+      RunVectorOfDeques<std::deque<Tracked>>("std::deque", vector_size));
+
+  WriteBenchmarkJson(args.OutPath(), "deque", results);
+  return 0;
+}
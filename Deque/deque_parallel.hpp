@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "deque.hpp"
+
+// Параллельные алгоритмы над Deque. Работа делится между потоками по
+// границам блоков: каждый поток получает целые блоки подряд, поэтому
+// потоки не пишут в одну кэш-линию, а внутри блока циклы идут по обычному
+// массиву.
+
+// Число потоков по умолчанию.
+inline size_t DequeParallelThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+namespace deque_parallel_detail {
+
+// Куски дека и их распределение по потокам: поток t обрабатывает
+// segments[bounds[t]] .. segments[bounds[t + 1] - 1], а offsets[i] - номер
+// первого элемента segments[i] в деке (offsets.back() - размер дека).
+template <typename Elem>
+struct Parts {
+  std::vector<std::span<Elem>> segments;
+  std::vector<size_t> offsets;
+  std::vector<size_t> bounds;
+
+  size_t threads() const { return bounds.size() - 1; }
+
+  // Номер первого элемента части потока t.
+  size_t start(size_t thread) const { return offsets[bounds[thread]]; }
+};
+
+template <typename Elem, typename DequeType>
+Parts<Elem> Split(DequeType& deque, size_t threads) {
+  Parts<Elem> parts;
+  parts.offsets.push_back(0);
+  deque.for_each_segment([&parts](std::span<Elem> segment) {
+    parts.segments.push_back(segment);
+    parts.offsets.push_back(parts.offsets.back() + segment.size());
+  });
+  size_t total = parts.offsets.back();
+  threads = std::clamp<size_t>(threads, 1,
+                               std::max<size_t>(parts.segments.size(), 1));
+  parts.bounds.push_back(0);
+  size_t segment = 0;
+  for (size_t thread = 1; thread < threads; ++thread) {
+    size_t target = total / threads * thread;
+    while (segment < parts.segments.size() &&
+           parts.offsets[segment + 1] <= target) {
+      ++segment;
+    }
+    if (segment > parts.bounds.back()) {
+      parts.bounds.push_back(segment);
+    }
+  }
+  parts.bounds.push_back(parts.segments.size());
+  return parts;
+}
+
+// Вызывает func(t) для t из [0, threads) в разных потоках (t == 0 - в
+// текущем) и пробрасывает первое исключение.
+template <typename Func>
+void RunParallel(size_t threads, Func func) {
+  std::vector<std::exception_ptr> errors(threads);
+  auto guarded = [&func, &errors](size_t thread) {
+    try {
+      func(thread);
+    } catch (...) {
+      errors[thread] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t thread = 1; thread < threads; ++thread) {
+    workers.emplace_back(guarded, thread);
+  }
+  guarded(0);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  for (std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+// Сколько элементов из first (длины first_size) попадает в первые k
+// элементов устойчивого слияния first и second (длины second_size).
+template <typename Iter, typename Compare>
+size_t CoRank(size_t k, Iter first, size_t first_size, Iter second,
+              size_t second_size, Compare& comp) {
+  size_t low = k > second_size ? k - second_size : 0;
+  size_t high = std::min(k, first_size);
+  while (low < high) {
+    size_t taken = low + (high - low) / 2;
+    if (!comp(second[k - taken - 1], first[taken])) {
+      low = taken + 1;
+    } else {
+      high = taken;
+    }
+  }
+  return low;
+}
+
+// Один проход сортировки слиянием: соседние пары отсортированных кусков
+// runs из source сливаются в dest. Поток t пишет элементы
+// [starts[t], starts[t + 1]) результата. Где эти границы приходятся на
+// каждый из двух кусков, CoRank находит до слияния: во время слияния
+// соседний поток уже забирает элементы из source.
+template <typename Source, typename Dest, typename Compare>
+void MergeRound(Source source, Dest dest, const std::vector<size_t>& runs,
+                const std::vector<size_t>& starts, Compare& comp) {
+  // Пара кусков, в которую попадает позиция pos: runs[pair], runs[pair + 1]
+  // и конец пары.
+  auto pair_of = [&runs](size_t pos) {
+    size_t pair = 0;
+    while (pair + 3 < runs.size() && runs[pair + 2] <= pos) {
+      pair += 2;
+    }
+    return pair;
+  };
+  auto pair_end = [&runs](size_t pair) {
+    return pair + 2 < runs.size() ? runs[pair + 2] : runs[pair + 1];
+  };
+  std::vector<size_t> splits(starts.size());
+  for (size_t ind = 0; ind < starts.size(); ++ind) {
+    size_t pair = pair_of(starts[ind]);
+    size_t first = runs[pair];
+    size_t middle = runs[pair + 1];
+    splits[ind] = CoRank(starts[ind] - first, source + first, middle - first,
+                         source + middle, pair_end(pair) - middle, comp);
+  }
+  RunParallel(starts.size() - 1, [&](size_t thread) {
+    size_t low = starts[thread];
+    size_t high = starts[thread + 1];
+    for (size_t run = 0; run + 1 < runs.size(); run += 2) {
+      size_t first = runs[run];
+      size_t middle = runs[run + 1];
+      size_t last = pair_end(run);
+      if (last <= low || first >= high) {
+        continue;
+      }
+      size_t from = std::max(low, first) - first;
+      size_t to = std::min(high, last) - first;
+      size_t left_from = low > first ? splits[thread] : 0;
+      size_t left_to = high < last ? splits[thread + 1] : middle - first;
+      std::merge(std::make_move_iterator(source + (first + left_from)),
+                 std::make_move_iterator(source + (first + left_to)),
+                 std::make_move_iterator(source + (middle + from - left_from)),
+                 std::make_move_iterator(source + (middle + to - left_to)),
+                 dest + (first + from), comp);
+    }
+  });
+}
+
+}  // namespace deque_parallel_detail
+
+// Вызывает func(элемент) для каждого элемента.
+template <typename T, typename Allocator, size_t kBlockSize, typename Func>
+void parallel_for_each(Deque<T, Allocator, kBlockSize>& deque, Func func,
+                       size_t threads = DequeParallelThreads()) {
+  auto parts = deque_parallel_detail::Split<T>(deque, threads);
+  deque_parallel_detail::RunParallel(parts.threads(), [&](size_t thread) {
+    for (size_t ind = parts.bounds[thread]; ind < parts.bounds[thread + 1];
+         ++ind) {
+      for (T& value : parts.segments[ind]) {
+        func(value);
+      }
+    }
+  });
+}
+
+// Записывает op(source[i]) в dest[i]; dest должен быть не короче source.
+// dest может совпадать с source.
+template <typename T, typename Allocator, size_t kBlockSize, typename U,
+          typename OtherAllocator, size_t kOtherBlockSize, typename Op>
+void parallel_transform(const Deque<T, Allocator, kBlockSize>& source,
+                        Deque<U, OtherAllocator, kOtherBlockSize>& dest, Op op,
+                        size_t threads = DequeParallelThreads()) {
+  if (dest.size() < source.size()) {
+    throw std::out_of_range("destination is shorter than source");
+  }
+  auto parts = deque_parallel_detail::Split<const T>(source, threads);
+  deque_parallel_detail::RunParallel(parts.threads(), [&](size_t thread) {
+    auto out = dest.begin() + parts.start(thread);
+    for (size_t ind = parts.bounds[thread]; ind < parts.bounds[thread + 1];
+         ++ind) {
+      for (const T& value : parts.segments[ind]) {
+        *out = op(value);
+        ++out;
+      }
+    }
+  });
+}
+
+// Сворачивает элементы операцией op вместе с init. Как и std::reduce,
+// порядок применения op не задан: op должна быть ассоциативной и
+// коммутативной.
+template <typename T, typename Allocator, size_t kBlockSize, typename U,
+          typename Op = std::plus<>>
+U parallel_reduce(const Deque<T, Allocator, kBlockSize>& deque, U init,
+                  Op op = {}, size_t threads = DequeParallelThreads()) {
+  auto parts = deque_parallel_detail::Split<const T>(deque, threads);
+  std::vector<std::optional<U>> partial(parts.threads());
+  deque_parallel_detail::RunParallel(parts.threads(), [&](size_t thread) {
+    std::optional<U> acc;
+    for (size_t ind = parts.bounds[thread]; ind < parts.bounds[thread + 1];
+         ++ind) {
+      for (const T& value : parts.segments[ind]) {
+        if (acc) {
+          acc = op(std::move(*acc), value);
+        } else {
+          acc.emplace(value);
+        }
+      }
+    }
+    partial[thread] = std::move(acc);
+  });
+  for (std::optional<U>& acc : partial) {
+    if (acc) {
+      init = op(std::move(init), std::move(*acc));
+    }
+  }
+  return init;
+}
+
+// Сортирует дек: каждый поток сортирует свои блоки, затем куски сливаются
+// попарно через буфер, и каждое слияние тоже делится между всеми потоками.
+// Буфер - std::vector<T> размера дека, поэтому T должен быть конструируемым
+// по умолчанию. Сортировка неустойчива (первая фаза - std::sort).
+template <typename T, typename Allocator, size_t kBlockSize,
+          typename Compare = std::less<>>
+void parallel_sort(Deque<T, Allocator, kBlockSize>& deque, Compare comp = {},
+                   size_t threads = DequeParallelThreads()) {
+  auto parts = deque_parallel_detail::Split<T>(deque, threads);
+  auto begin = deque.begin();
+  std::vector<size_t> starts;
+  for (size_t thread = 0; thread <= parts.threads(); ++thread) {
+    starts.push_back(parts.offsets[parts.bounds[thread]]);
+  }
+  deque_parallel_detail::RunParallel(parts.threads(), [&](size_t thread) {
+    std::sort(begin + starts[thread], begin + starts[thread + 1], comp);
+  });
+  if (parts.threads() == 1) {
+    return;
+  }
+
+  std::vector<T> buffer(deque.size());
+  std::vector<size_t> runs = starts;
+  runs.pop_back();
+  bool in_buffer = false;
+  while (runs.size() > 1) {
+    runs.push_back(deque.size());
+    if (in_buffer) {
+      deque_parallel_detail::MergeRound(buffer.begin(), begin, runs, starts,
+                                        comp);
+    } else {
+      deque_parallel_detail::MergeRound(begin, buffer.begin(), runs, starts,
+                                        comp);
+    }
+    in_buffer = !in_buffer;
+    std::vector<size_t> merged;
+    for (size_t run = 0; run + 1 < runs.size(); run += 2) {
+      merged.push_back(runs[run]);
+    }
+    runs = std::move(merged);
+  }
+  if (in_buffer) {
+    deque_parallel_detail::RunParallel(parts.threads(), [&](size_t thread) {
+      std::move(buffer.begin() + starts[thread],
+                buffer.begin() + starts[thread + 1], begin + starts[thread]);
+    });
+  }
+}
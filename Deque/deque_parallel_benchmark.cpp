@@ -0,0 +1,145 @@
+// Параллельные алгоритмы над Deque (deque_parallel.hpp) против
+// std::execution::par на обычных итераторах дека.
+//
+//   deque_parallel_benchmark [--size N] [--max-threads N] [--out file.json]
+//
+// Без TBB std::execution::par в libstdc++ выполняется последовательно,
+// поэтому варианты с ним собираются только при DEQUE_BENCHMARK_EXECUTION.
+// Результат - JSON, чтобы сравнивать прогоны между версиями.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef DEQUE_BENCHMARK_EXECUTION
+#include <execution>
+#endif
+
+#include "../Benchmark/benchmark.hpp"
+#include "deque.hpp"
+#include "deque_parallel.hpp"
+
+namespace {
+
+Deque<uint64_t> MakeData(size_t size) {
+  Deque<uint64_t> deque;
+  std::mt19937_64 rng(42);
+  for (size_t ind = 0; ind < size; ++ind) {
+    deque.push_back(rng() % 1'000'000'007);
+  }
+  return deque;
+}
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::cerr << what << " mismatch\n";
+    std::exit(1);
+  }
+}
+
+// Замер одного алгоритма: name - что делается, impl - чем, run - сам прогон
+// над копией данных.
+template <typename Run>
+BenchmarkRow Measure(const std::string& name, const std::string& impl,
+                     size_t threads, const Deque<uint64_t>& data, Run run) {
+  Deque<uint64_t> deque(data);
+  uint64_t start = NowNs();
+  run(deque);
+  uint64_t elapsed = NowNs() - start;
+  return BenchmarkRow()
+      .Add("name", name)
+      .Add("impl", impl)
+      .Add("threads", threads)
+      .Add("size", data.size())
+      .Add("ms", elapsed / 1e6);
+}
+
+void RunBlockwise(const Deque<uint64_t>& data, size_t threads,
+                  uint64_t expected_sum, std::vector<BenchmarkRow>& results) {
+  results.push_back(Measure("for_each", "deque_parallel", threads, data,
+                            [threads](Deque<uint64_t>& deque) {
+                              parallel_for_each(
+                                  deque, [](uint64_t& value) { value *= 3; },
+                                  threads);
+                            }));
+  results.push_back(Measure(
+      "transform", "deque_parallel", threads, data,
+      [threads](Deque<uint64_t>& deque) {
+        parallel_transform(
+            deque, deque, [](uint64_t value) { return value ^ (value >> 7); },
+            threads);
+      }));
+  results.push_back(Measure("reduce", "deque_parallel", threads, data,
+                            [threads, expected_sum](Deque<uint64_t>& deque) {
+                              uint64_t sum = parallel_reduce(
+                                  deque, uint64_t{0}, std::plus<>{}, threads);
+                              Check(sum == expected_sum, "reduce");
+                              sink = sum;
+                            }));
+  results.push_back(Measure("sort", "deque_parallel", threads, data,
+                            [threads](Deque<uint64_t>& deque) {
+                              parallel_sort(deque, std::less<>{}, threads);
+                              Check(std::is_sorted(deque.begin(), deque.end()),
+                                    "sort");
+                            }));
+}
+
+// Без политики - однопоточная база; с std::execution::par - обобщённая
+// параллельная версия, которая видит в деке только итераторы.
+template <typename... Policy>
+void RunGeneric(const std::string& impl, const Deque<uint64_t>& data,
+                size_t threads, uint64_t expected_sum,
+                std::vector<BenchmarkRow>& results, Policy... policy) {
+  results.push_back(
+      Measure("for_each", impl, threads, data, [&](Deque<uint64_t>& deque) {
+        std::for_each(policy..., deque.begin(), deque.end(),
+                      [](uint64_t& value) { value *= 3; });
+      }));
+  results.push_back(
+      Measure("transform", impl, threads, data, [&](Deque<uint64_t>& deque) {
+        std::transform(policy..., deque.begin(), deque.end(), deque.begin(),
+                       [](uint64_t value) { return value ^ (value >> 7); });
+      }));
+  results.push_back(
+      Measure("reduce", impl, threads, data, [&](Deque<uint64_t>& deque) {
+        uint64_t sum =
+            std::reduce(policy..., deque.begin(), deque.end(), uint64_t{0});
+        Check(sum == expected_sum, "reduce");
+        sink = sum;
+      }));
+  results.push_back(
+      Measure("sort", impl, threads, data, [&](Deque<uint64_t>& deque) {
+        std::sort(policy..., deque.begin(), deque.end());
+        Check(std::is_sorted(deque.begin(), deque.end()), "sort");
+      }));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkArgs args(argc, argv);
+  size_t size = args.Number("--size", 20'000'000);
+  size_t max_threads = args.Number("--max-threads", DequeParallelThreads());
+
+  Deque<uint64_t> data = MakeData(size);
+  uint64_t expected_sum = std::accumulate(data.begin(), data.end(),
+                                          uint64_t{0});
+  std::vector<BenchmarkRow> results;
+  RunGeneric("std_serial", data, 1, expected_sum, results);
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    RunBlockwise(data, threads, expected_sum, results);
+  }
+#ifdef DEQUE_BENCHMARK_EXECUTION
+  RunGeneric("std_execution_par", data, max_threads, expected_sum, results,
+             std::execution::par);
+#endif
+
+  WriteBenchmarkJson(args.OutPath(), "deque_parallel", results);
+  return 0;
+}
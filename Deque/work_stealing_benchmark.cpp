@@ -0,0 +1,263 @@
+// Fork-join планировщик на деке Чейза - Лева против Deque под мьютексом:
+// параллельные числа Фибоначчи и быстрая сортировка.
+//
+//   work_stealing_benchmark [--fib N] [--sort N] [--max-threads N]
+//                           [--out file.json]
+//
+// Результат - JSON, чтобы сравнивать прогоны между версиями.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Benchmark/benchmark.hpp"
+#include "deque.hpp"
+#include "work_stealing_deque.hpp"
+
+namespace {
+
+BenchmarkRow Row(const std::string& name, const std::string& queue,
+                 size_t threads, uint64_t size, uint64_t elapsed_ns,
+                 uint64_t steals) {
+  return BenchmarkRow()
+      .Add("name", name)
+      .Add("queue", queue)
+      .Add("threads", threads)
+      .Add("size", size)
+      .Add("ms", elapsed_ns / 1e6)
+      .Add("steals", steals);
+}
+
+struct Task {
+  void (*run)(Task*);
+  std::atomic<bool> done = false;
+};
+
+// Deque, каждый доступ к которому - под мьютексом.
+class LockedDeque {
+ public:
+  void push_back(Task* task) {
+    std::lock_guard lock(mutex_);
+    deque_.push_back(task);
+  }
+
+  bool pop_back(Task** task) {
+    std::lock_guard lock(mutex_);
+    if (deque_.empty()) {
+      return false;
+    }
+    *task = *(deque_.end() - 1);
+    deque_.pop_back();
+    return true;
+  }
+
+  bool steal_front(Task** task) {
+    std::lock_guard lock(mutex_);
+    if (deque_.empty()) {
+      return false;
+    }
+    *task = *deque_.begin();
+    deque_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  Deque<Task*> deque_;
+};
+
+// Каждый поток кладёт порождённые задачи в свой дек и, ожидая задачу,
+// выполняет свои или крадёт чужие.
+template <typename Queue>
+class Scheduler {
+ public:
+  explicit Scheduler(size_t threads) : queues_(threads) {}
+
+  // Выполняет root в текущем потоке и threads - 1 помощниках.
+  void Run(Task* root) {
+    stop_.store(false, std::memory_order_relaxed);
+    std::vector<std::thread> helpers;
+    for (size_t id = 1; id < queues_.size(); ++id) {
+      helpers.emplace_back([this, id] {
+        worker_id = id;
+        while (!stop_.load(std::memory_order_acquire)) {
+          if (!RunOne()) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    worker_id = 0;
+    Execute(root);
+    stop_.store(true, std::memory_order_release);
+    for (std::thread& helper : helpers) {
+      helper.join();
+    }
+  }
+
+  void Spawn(Task* task) { queues_[worker_id].push_back(task); }
+
+  void Wait(Task* task) {
+    while (!task->done.load(std::memory_order_acquire)) {
+      if (!RunOne()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  uint64_t Steals() const { return steals_.load(); }
+
+ private:
+  std::vector<Queue> queues_;
+  std::atomic<bool> stop_ = false;
+  std::atomic<uint64_t> steals_ = 0;
+  static thread_local size_t worker_id;
+
+  void Execute(Task* task) {
+    task->run(task);
+    task->done.store(true, std::memory_order_release);
+  }
+
+  bool RunOne() {
+    Task* task;
+    if (queues_[worker_id].pop_back(&task)) {
+      Execute(task);
+      return true;
+    }
+    for (size_t shift = 1; shift < queues_.size(); ++shift) {
+      size_t victim = (worker_id + shift) % queues_.size();
+      if (queues_[victim].steal_front(&task)) {
+        steals_.fetch_add(1, std::memory_order_relaxed);
+        Execute(task);
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+template <typename Queue>
+thread_local size_t Scheduler<Queue>::worker_id = 0;
+
+constexpr int kFibCutoff = 12;
+constexpr size_t kSortCutoff = 4096;
+
+uint64_t SerialFib(int n) {
+  return n < 2 ? n : SerialFib(n - 1) + SerialFib(n - 2);
+}
+
+template <typename Queue>
+struct FibTask : Task {
+  Scheduler<Queue>* scheduler;
+  int n;
+  uint64_t result = 0;
+
+  FibTask(Scheduler<Queue>* sched, int num)
+      : Task{&Run}, scheduler(sched), n(num) {}
+
+  static void Run(Task* base) {
+    auto* self = static_cast<FibTask*>(base);
+    if (self->n < kFibCutoff) {
+      self->result = SerialFib(self->n);
+      return;
+    }
+    FibTask child(self->scheduler, self->n - 1);
+    self->scheduler->Spawn(&child);
+    FibTask other(self->scheduler, self->n - 2);
+    Run(&other);
+    self->scheduler->Wait(&child);
+    self->result = child.result + other.result;
+  }
+};
+
+template <typename Queue>
+struct SortTask : Task {
+  Scheduler<Queue>* scheduler;
+  uint64_t* first;
+  uint64_t* last;
+
+  SortTask(Scheduler<Queue>* sched, uint64_t* begin, uint64_t* end)
+      : Task{&Run}, scheduler(sched), first(begin), last(end) {}
+
+  static void Run(Task* base) {
+    auto* self = static_cast<SortTask*>(base);
+    if (static_cast<size_t>(self->last - self->first) < kSortCutoff) {
+      std::sort(self->first, self->last);
+      return;
+    }
+    uint64_t pivot = self->first[(self->last - self->first) / 2];
+    uint64_t* middle =
+        std::partition(self->first, self->last,
+                       [pivot](uint64_t value) { return value < pivot; });
+    uint64_t* upper =
+        std::partition(middle, self->last,
+                       [pivot](uint64_t value) { return value == pivot; });
+    SortTask child(self->scheduler, self->first, middle);
+    self->scheduler->Spawn(&child);
+    SortTask other(self->scheduler, upper, self->last);
+    Run(&other);
+    self->scheduler->Wait(&child);
+  }
+};
+
+template <typename Queue>
+BenchmarkRow RunFib(const std::string& queue, size_t threads, int n) {
+  Scheduler<Queue> scheduler(threads);
+  FibTask<Queue> root(&scheduler, n);
+  uint64_t start = NowNs();
+  scheduler.Run(&root);
+  uint64_t elapsed = NowNs() - start;
+  if (root.result != SerialFib(n)) {
+    std::cerr << "fib mismatch\n";
+    std::exit(1);
+  }
+  return Row("fib", queue, threads, n, elapsed, scheduler.Steals());
+}
+
+template <typename Queue>
+BenchmarkRow RunSort(const std::string& queue, size_t threads, size_t size) {
+  std::vector<uint64_t> data(size);
+  std::mt19937_64 rng(42);
+  for (uint64_t& value : data) {
+    value = rng();
+  }
+  Scheduler<Queue> scheduler(threads);
+  SortTask<Queue> root(&scheduler, data.data(), data.data() + data.size());
+  uint64_t start = NowNs();
+  scheduler.Run(&root);
+  uint64_t elapsed = NowNs() - start;
+  if (!std::is_sorted(data.begin(), data.end())) {
+    std::cerr << "sort mismatch\n";
+    std::exit(1);
+  }
+  return Row("quicksort", queue, threads, size, elapsed, scheduler.Steals());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkArgs args(argc, argv);
+  int fib = args.Number("--fib", 32);
+  size_t sort_size = args.Number("--sort", 4'000'000);
+  size_t max_threads = args.Number(
+      "--max-threads", std::max(1u, std::thread::hardware_concurrency()));
+
+  using ChaseLev = WorkStealingDeque<Task*>;
+  std::vector<BenchmarkRow> results;
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    results.push_back(RunFib<ChaseLev>("chase_lev", threads, fib));
+    results.push_back(RunFib<LockedDeque>("mutex_deque", threads, fib));
+    results.push_back(RunSort<ChaseLev>("chase_lev", threads, sort_size));
+    results.push_back(RunSort<LockedDeque>("mutex_deque", threads, sort_size));
+  }
+
+  WriteBenchmarkJson(args.OutPath(), "work_stealing", results);
+  return 0;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "../Ring-Buffer/cache_line.hpp"
+#include "deque.hpp"
+
+// Сколько блоков в карте у нового дека.
+inline constexpr size_t kStealInitialBlocks = 4;
+
+// Дек для планировщика задач по схеме Чейза - Лева. Владелец (один поток)
+// кладёт и забирает элементы с конца: push_back/pop_back обходятся без
+// атомарных read-modify-write, кроме спора с ворами за последний элемент.
+// Любые другие потоки забирают элементы с начала через steal_front без
+// блокировок.
+//
+// Как и Deque, хранит элементы в блоках по kBlockSize, на которые указывает
+// карта. Карта кольцевая: элемент с номером i лежит в блоке i / kBlockSize
+// по модулю числа блоков. Когда места не хватает, карта удваивается, а
+// блоки переходят в новую карту без копирования элементов. Старые карты
+// живут до разрушения дека, потому что вор мог успеть их прочитать.
+//
+// Воры читают ячейки одновременно с записью владельца, поэтому ячейки -
+// std::atomic<T>, а T должен быть тривиально копируемым и lock-free
+// атомарным (указатель на задачу, индекс и т.п.).
+template <typename T, size_t kBlockSize = DequeBlockSize(sizeof(T))>
+class WorkStealingDeque {
+  static_assert(std::has_single_bit(kBlockSize),
+                "block size must be a power of two");
+  static_assert(std::is_trivially_copyable_v<T> &&
+                    std::atomic<T>::is_always_lock_free,
+                "elements must be lock-free atomic");
+
+ public:
+  explicit WorkStealingDeque(size_t blocks = kStealInitialBlocks) {
+    size_t count = std::bit_ceil(std::max<size_t>(blocks, 2));
+    Map* map = add_map(count);
+    for (size_t ind = 0; ind < count; ++ind) {
+      map->blocks[ind] = add_block();
+    }
+    map_.store(map, std::memory_order_relaxed);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // Вызывается только владельцем.
+  void push_back(const T& value) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    Map* map = map_.load(std::memory_order_relaxed);
+    if (bottom - top >= capacity(map)) {
+      map = grow(map, top, bottom);
+    }
+    slot(map, bottom).store(value, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+  }
+
+  // Вызывается только владельцем. false, если дек пуст или последний
+  // элемент только что украли.
+  bool pop_back(T* value) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Map* map = map_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+    *value = slot(map, bottom).load(std::memory_order_relaxed);
+    if (top < bottom) {
+      return true;
+    }
+    // Последний элемент: забирает тот, кто первым сдвинет верх.
+    bool won = top_.compare_exchange_strong(top, top + 1,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  // Вызывается любым потоком. false, если дек пуст или другой поток успел
+  // забрать этот элемент раньше.
+  bool steal_front(T* value) {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return false;
+    }
+    Map* map = map_.load(std::memory_order_acquire);
+    T stolen = slot(map, top).load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    *value = stolen;
+    return true;
+  }
+
+  // Размер на момент вызова; при одновременной работе других потоков -
+  // только оценка.
+  size_t size() const {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    return bottom > top ? bottom - top : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+ private:
+  using Slot = std::atomic<T>;
+
+  struct Map {
+    size_t mask;                       // число блоков - 1
+    std::unique_ptr<Slot*[]> blocks;  // блоки по модулю числа блоков
+  };
+
+  static constexpr int kShift = std::countr_zero(kBlockSize);
+
+  // Верх и низ лежат на разных линиях, чтобы воры, двигающие верх, не
+  // мешали владельцу.
+  alignas(kCacheLineSize) std::atomic<int64_t> top_ = 0;
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom_ = 0;
+  std::atomic<Map*> map_;
+  // Ниже - данные владельца: все карты (последняя - текущая) и все блоки.
+  std::vector<std::unique_ptr<Map>> maps_;
+  std::vector<std::unique_ptr<Slot[]>> blocks_;
+
+  // Элементов помещается на блок меньше, чем в карте: тогда живые элементы
+  // занимают не больше mask + 1 подряд идущих блоков, и их номера по модулю
+  // числа блоков не совпадают.
+  static int64_t capacity(const Map* map) {
+    return static_cast<int64_t>(map->mask) * kBlockSize;
+  }
+
+  static Slot& slot(Map* map, int64_t index) {
+    return map->blocks[(index >> kShift) & map->mask]
+                      [index & (kBlockSize - 1)];
+  }
+
+  Map* add_map(size_t count) {
+    maps_.push_back(std::make_unique<Map>(
+        Map{count - 1, std::make_unique<Slot*[]>(count)}));
+    return maps_.back().get();
+  }
+
+  Slot* add_block() {
+    blocks_.push_back(std::make_unique<Slot[]>(kBlockSize));
+    return blocks_.back().get();
+  }
+
+  // Удваивает карту. Блоки с живыми элементами [top, bottom] встают на
+  // свои места в новой карте, остальные старые блоки и новые занимают
+  // свободные места.
+  Map* grow(Map* old, int64_t top, int64_t bottom) {
+    size_t count = 2 * (old->mask + 1);
+    Map* map = add_map(count);
+    std::vector<bool> moved(old->mask + 1, false);
+    for (int64_t block = top >> kShift; block <= bottom >> kShift; ++block) {
+      map->blocks[block & map->mask] = old->blocks[block & old->mask];
+      moved[block & old->mask] = true;
+    }
+    size_t spare = 0;
+    for (size_t ind = 0; ind < count; ++ind) {
+      if (map->blocks[ind] != nullptr) {
+        continue;
+      }
+      while (spare <= old->mask && moved[spare]) {
+        ++spare;
+      }
+      map->blocks[ind] =
+          spare <= old->mask ? old->blocks[spare++] : add_block();
+    }
+    map_.store(map, std::memory_order_release);
+    return map;
+  }
+};
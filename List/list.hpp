@@ -2,9 +2,18 @@
 #include <stdlib.h>
 
 #include <algorithm>
+#include <exception>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
+
+// Меньше стольких элементов на поток параллельная сортировка не делится.
+inline constexpr size_t kListParallelSortGrain = 1 << 14;
 
 template <typename T, typename Allocator = std::allocator<T>>
 class List {
@@ -27,6 +36,8 @@ class List {
 
   List() {}
 
+  explicit List(const Allocator& alloc) : alloc_(alloc) {}
+
   explicit List(size_t count, const Allocator& alloc = Allocator())
       : alloc_(alloc) {
     for (size_t ind = 0; ind < count; ++ind) {
@@ -43,19 +54,28 @@ class List {
   }
 
   List(size_t count, const T& value, const Allocator& alloc = Allocator())
-      : List(count, alloc) {
-    for (iterator iter = begin(); iter != end(); ++iter) {
-      *iter = value;
+      : alloc_(alloc) {
+    for (size_t ind = 0; ind < count; ++ind) {
+      node* new_node = alloc_traits::allocate(alloc_, 1);
+      try {
+        construct_node_back(new_node, value);
+      } catch (...) {
+        alloc_traits::deallocate(alloc_, new_node, 1);
+        destroy_list();
+        throw;
+      }
     }
   }
 
   List(const List& other)
-      : alloc_(
-            alloc_traits::select_on_container_copy_construction(other.alloc_)) {
-    for (iterator iter = other.begin(); iter != other.end(); ++iter) {
+      : List(other, alloc_traits::select_on_container_copy_construction(
+                        other.alloc_)) {}
+
+  List(const List& other, const Allocator& alloc) : alloc_(alloc) {
+    for (const_iterator iter = other.cbegin(); iter != other.cend(); ++iter) {
       node* new_node = alloc_traits::allocate(alloc_, 1);
       try {
-        construct_node_back(new_node, std::move(*iter));
+        construct_node_back(new_node, *iter);
       } catch (...) {
         alloc_traits::deallocate(alloc_, new_node, 1);
         destroy_list();
@@ -69,7 +89,7 @@ class List {
     for (auto iter = init.begin(); iter != init.end(); ++iter) {
       node* new_node = alloc_traits::allocate(alloc_, 1);
       try {
-        construct_node_back(new_node, std::move(*iter));
+        construct_node_back(new_node, *iter);
       } catch (...) {
         alloc_traits::deallocate(alloc_, new_node, 1);
         destroy_list();
@@ -78,83 +98,107 @@ class List {
     }
   }
 
+  // Забирает узлы other за O(1): в этот список переходят ссылки fake_
+  // и размер, other остаётся пустым со своей копией аллокатора.
+  List(List&& other) noexcept : alloc_(other.alloc_) { swap_nodes(other); }
+
   ~List() { destroy_list(); }
 
+  // Копия строится на том аллокаторе, который будет у списка после
+  // присваивания, и вместе с ним обменивается узлами со старым содержимым:
+  // старые узлы освобождает тот аллокатор, который их выделил.
   List& operator=(const List& other) {
-    List copy(other);
-    if (alloc_traits::propagate_on_container_copy_assignment::value &&
-        alloc_ != other.alloc_) {
-      alloc_ = other.alloc_;
+    bool propagate =
+        alloc_traits::propagate_on_container_copy_assignment::value &&
+        alloc_ != other.alloc_;
+    List copy(other, propagate ? other.alloc_ : alloc_);
+    if (propagate) {
+      std::swap(alloc_, copy.alloc_);
     }
 
-    if (!empty()) {
-      std::swap((&fake_)->next->prev, (&copy.fake_)->next->prev);
-      std::swap((&fake_)->prev->next, (&copy.fake_)->prev->next);
+    swap_nodes(copy);
+    return *this;
+  }
+
+  // Узлы other забираются целиком, если аллокатор переходит вместе с ними
+  // или аллокаторы равны; иначе элементы переносятся по одному.
+  List& operator=(List&& other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value) {
+    if (this == &other) {
+      return *this;
+    }
+    destroy_list();
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                      value) {
+      alloc_ = other.alloc_;
+      swap_nodes(other);
+    } else if (alloc_ == other.alloc_) {
+      swap_nodes(other);
     } else {
-      (&copy.fake_)->prev->next = static_cast<node*>(&fake_);
-      (&copy.fake_)->next->prev = static_cast<node*>(&fake_);
+      for (T& value : other) {
+        emplace_back(std::move(value));
+      }
+      other.destroy_list();
     }
-    std::swap(fake_, copy.fake_);
-    std::swap(now_sz_, copy.now_sz_);
     return *this;
   }
 
+  // Аллокаторы обмениваются, только если этого требует
+  // propagate_on_container_swap; иначе они должны быть равны.
+  void swap(List& other) noexcept {
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+      using std::swap;
+      swap(alloc_, other.alloc_);
+    }
+    swap_nodes(other);
+  }
+
+  friend void swap(List& first, List& second) noexcept { first.swap(second); }
+
   iterator begin() const {
-    iterator begin((&fake_)->next);
+    iterator begin(first_node());
     return begin;
   }
 
   iterator end() const {
-    iterator end((&fake_)->prev);
-    ++end;
+    iterator end(sentinel());
     return end;
   }
 
   const_iterator cbegin() const {
-    const_iterator const_begin((&fake_)->next);
+    const_iterator const_begin(first_node());
     return const_begin;
   }
 
   const_iterator cend() const {
-    const_iterator const_end(static_cast<node*>(&fake_));
+    const_iterator const_end(sentinel());
     return const_end;
   }
 
   const_reverse_iterator rbegin() const {
-    const_iterator const_end(static_cast<node*>(&fake_));
-    return std::make_reverse_iterator(const_end);
+    return std::make_reverse_iterator(cend());
   }
 
   const_reverse_iterator rend() const {
-    const_iterator const_begin((&fake_)->next);
-    return std::make_reverse_iterator(const_begin);
+    return std::make_reverse_iterator(cbegin());
   }
 
-  reverse_iterator rbegin() {
-    return std::make_reverse_iterator(end(static_cast<node*>(&fake_)));
-  }
+  reverse_iterator rbegin() { return std::make_reverse_iterator(end()); }
 
-  reverse_iterator rend() {
-    return std::make_reverse_iterator(begin_((&fake_)->next));
-  }
+  reverse_iterator rend() { return std::make_reverse_iterator(begin()); }
 
-  const_reverse_iterator crbegin() const {
-    const_iterator const_end(static_cast<node*>(&fake_));
-    return std::make_reverse_iterator(const_end);
-  }
+  const_reverse_iterator crbegin() const { return rbegin(); }
 
-  const_reverse_iterator crend() const {
-    const_iterator const_begin(fake_->next);
-    return make_reverse_iterator(const_begin);
-  }
+  const_reverse_iterator crend() const { return rend(); }
 
-  T& front() { return fake_->next->value; }
+  T& front() { return fake_.next->value; }
 
-  const T& front() const { return fake_->next->value; }
+  const T& front() const { return fake_.next->value; }
 
-  T& back() { return fake_->prev->value; }
+  T& back() { return fake_.prev->value; }
 
-  const T& back() const { return fake_->prev->value; }
+  const T& back() const { return fake_.prev->value; }
 
   bool empty() const { return (now_sz_ == 0); }
 
@@ -162,31 +206,17 @@ class List {
 
   void push_back(const T& value) {
     node* new_node = alloc_traits::allocate(alloc_, 1);
-    construct_node_back(new_node, std::move(value));
+    construct_node_back(new_node, value);
   }
 
   void push_front(const T& value) {
     node* new_node = alloc_traits::allocate(alloc_, 1);
-    construct_node_front(new_node, std::move(value));
+    construct_node_front(new_node, value);
   }
 
-  void pop_back() {
-    node* new_node = (&fake_)->prev;
-    (&fake_)->prev = new_node->prev;
-    new_node->prev->next = static_cast<node*>(&fake_);
-    alloc_traits::destroy(alloc_, new_node);
-    alloc_traits::deallocate(alloc_, new_node, 1);
-    --now_sz_;
-  }
+  void pop_back() { destroy_node((&fake_)->prev); }
 
-  void pop_front() {
-    node* new_node = (&fake_)->next;
-    (&fake_)->next = new_node->next;
-    new_node->next->prev = static_cast<node*>(&fake_);
-    alloc_traits::destroy(alloc_, new_node);
-    alloc_traits::deallocate(alloc_, new_node, 1);
-    --now_sz_;
-  }
+  void pop_front() { destroy_node((&fake_)->next); }
 
   void push_back(T&& value) {
     node* new_node = alloc_traits::allocate(alloc_, 1);
@@ -198,6 +228,281 @@ class List {
     construct_node_front(new_node, std::move(value));
   }
 
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    return *emplace(cend(), std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  T& emplace_front(Args&&... args) {
+    return *emplace(cbegin(), std::forward<Args>(args)...);
+  }
+
+  // Создаёт элемент перед pos и возвращает итератор на него.
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    node* new_node = alloc_traits::allocate(alloc_, 1);
+    try {
+      construct_node_before(pos.curr_, new_node, std::forward<Args>(args)...);
+    } catch (...) {
+      alloc_traits::deallocate(alloc_, new_node, 1);
+      throw;
+    }
+    return iterator(new_node);
+  }
+
+  iterator insert(const_iterator pos, const T& value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  // Удаляет элемент pos и возвращает итератор на следующий.
+  iterator erase(const_iterator pos) {
+    node* next = pos.curr_->next;
+    destroy_node(pos.curr_);
+    return iterator(next);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return iterator(last.curr_);
+  }
+
+  // splice переставляет узлы other в этот список перед pos, ничего не
+  // копируя и не выделяя; итераторы на перенесённые элементы остаются
+  // действительными. Аллокаторы списков должны быть равны.
+  void splice(const_iterator pos, List& other) {
+    if (other.empty()) {
+      return;
+    }
+    init_fake();
+    transfer(pos.curr_, other.fake_.next, other.sentinel());
+    now_sz_ += other.now_sz_;
+    other.now_sz_ = 0;
+  }
+
+  void splice(const_iterator pos, List&& other) { splice(pos, other); }
+
+  void splice(const_iterator pos, List& other, const_iterator iter) {
+    node* next = iter.curr_->next;
+    if (pos.curr_ == iter.curr_ || pos.curr_ == next) {
+      return;
+    }
+    init_fake();
+    transfer(pos.curr_, iter.curr_, next);
+    --other.now_sz_;
+    ++now_sz_;
+  }
+
+  void splice(const_iterator pos, List&& other, const_iterator iter) {
+    splice(pos, other, iter);
+  }
+
+  // Для чужого списка - O(длины диапазона): нужно пересчитать размеры.
+  void splice(const_iterator pos, List& other, const_iterator first,
+              const_iterator last) {
+    if (first == last) {
+      return;
+    }
+    if (&other != this) {
+      size_t count = std::distance(first, last);
+      other.now_sz_ -= count;
+      now_sz_ += count;
+    }
+    init_fake();
+    transfer(pos.curr_, first.curr_, last.curr_);
+  }
+
+  void splice(const_iterator pos, List&& other, const_iterator first,
+              const_iterator last) {
+    splice(pos, other, first, last);
+  }
+
+  // Сливает отсортированный other в этот отсортированный список
+  // перестановкой узлов. Устойчиво: из равных элементов свои идут раньше.
+  template <typename Compare>
+  void merge(List& other, Compare comp) {
+    if (&other == this || other.empty()) {
+      return;
+    }
+    init_fake();
+    node* pos = fake_.next;
+    node* from = other.fake_.next;
+    node* other_end = other.sentinel();
+    while (from != other_end) {
+      if (pos == sentinel()) {
+        now_sz_ += other.now_sz_;
+        other.now_sz_ = 0;
+        transfer(pos, from, other_end);
+        return;
+      }
+      if (!comp(from->value, pos->value)) {
+        pos = pos->next;
+        continue;
+      }
+      // Подряд идущие меньшие pos элементы other переносятся одним куском.
+      node* run_end = from->next;
+      size_t count = 1;
+      while (run_end != other_end && comp(run_end->value, pos->value)) {
+        run_end = run_end->next;
+        ++count;
+      }
+      other.now_sz_ -= count;
+      now_sz_ += count;
+      transfer(pos, from, run_end);
+      from = run_end;
+    }
+  }
+
+  template <typename Compare>
+  void merge(List&& other, Compare comp) {
+    merge(other, comp);
+  }
+
+  void merge(List& other) { merge(other, std::less<>()); }
+
+  void merge(List&& other) { merge(other, std::less<>()); }
+
+  // Удаляет элементы, для которых pred истинен, и возвращает их число.
+  // Узлы уничтожаются после обхода, поэтому pred может ссылаться на
+  // элемент самого списка.
+  template <typename Pred>
+  size_t remove_if(Pred pred) {
+    node* doomed = nullptr;
+    size_t removed = 0;
+    try {
+      for (node* curr = first_node(); curr != sentinel();) {
+        node* next = curr->next;
+        if (pred(curr->value)) {
+          unlink_node(curr);
+          curr->next = doomed;
+          doomed = curr;
+          ++removed;
+        }
+        curr = next;
+      }
+    } catch (...) {
+      free_chain(doomed);
+      throw;
+    }
+    free_chain(doomed);
+    return removed;
+  }
+
+  size_t remove(const T& value) {
+    return remove_if([&value](const T& elem) { return elem == value; });
+  }
+
+  // Из каждой группы подряд идущих элементов, для которых pred(первый
+  // элемент группы, элемент) истинен, оставляет первый.
+  template <typename BinaryPred>
+  size_t unique(BinaryPred pred) {
+    node* doomed = nullptr;
+    size_t removed = 0;
+    try {
+      node* kept = first_node();
+      for (node* curr = kept->next; kept != sentinel() && curr != sentinel();) {
+        node* next = curr->next;
+        if (pred(kept->value, curr->value)) {
+          unlink_node(curr);
+          curr->next = doomed;
+          doomed = curr;
+          ++removed;
+        } else {
+          kept = curr;
+        }
+        curr = next;
+      }
+    } catch (...) {
+      free_chain(doomed);
+      throw;
+    }
+    free_chain(doomed);
+    return removed;
+  }
+
+  size_t unique() { return unique(std::equal_to<>()); }
+
+  // Устойчивая сортировка слиянием снизу вверх: узлы переставляются, а не
+  // копируются, дополнительная память - O(1). Если comp бросает, все
+  // элементы остаются в списке в неопределённом порядке.
+  template <typename Compare>
+  void sort(Compare comp) {
+    if (now_sz_ < 2) {
+      return;
+    }
+    node* head = detach_chain();
+    try {
+      sort_chain(head, comp);
+    } catch (...) {
+      attach_chain(head);
+      throw;
+    }
+    attach_chain(head);
+  }
+
+  void sort() { sort(std::less<>()); }
+
+  // Параллельный режим: список режется на threads кусков, каждый
+  // сортируется в своём потоке, затем соседние куски попарно сливаются
+  // (разные пары - тоже в разных потоках). comp вызывается из нескольких
+  // потоков одновременно. Короткие списки сортируются в текущем потоке.
+  template <typename Compare>
+  void sort(Compare comp, size_t threads) {
+    threads = std::min(threads, now_sz_ / kListParallelSortGrain);
+    if (threads <= 1) {
+      sort(comp);
+      return;
+    }
+    std::vector<node*> heads(threads);
+    node* rest = detach_chain();
+    for (size_t piece = 0; piece < threads; ++piece) {
+      size_t size = now_sz_ / threads + (piece < now_sz_ % threads ? 1 : 0);
+      heads[piece] = rest;
+      for (size_t ind = 1; ind < size; ++ind) {
+        rest = rest->next;
+      }
+      node* last = rest;
+      rest = rest->next;
+      last->next = nullptr;
+    }
+    std::exception_ptr error = run_parallel(threads, [&](size_t piece) {
+      sort_chain(heads[piece], comp);
+    });
+    while (heads.size() > 1 && !error) {
+      size_t pairs = heads.size() / 2;
+      // merge_chains пишет результат прямо в heads[2 * pair]; если comp
+      // бросит, там окажутся все узлы обоих кусков.
+      error = run_parallel(pairs, [&](size_t pair) {
+        node* left = std::exchange(heads[2 * pair], nullptr);
+        node* right = std::exchange(heads[2 * pair + 1], nullptr);
+        merge_chains(heads[2 * pair], left, right, comp);
+      });
+      for (size_t pair = 0; pair < pairs; ++pair) {
+        heads[pair] = heads[2 * pair];
+      }
+      if (heads.size() % 2 == 1) {
+        heads[pairs++] = heads.back();
+      }
+      heads.resize(pairs);
+    }
+    if (error) {
+      // Куски склеиваются как есть, чтобы ни один узел не потерялся.
+      node* head = nullptr;
+      for (node* piece : heads) {
+        prepend_chain(head, piece);
+      }
+      attach_chain(head);
+      std::rethrow_exception(error);
+    }
+    attach_chain(heads.front());
+  }
+
   const typename std::allocator_traits<Allocator>::template rebind_alloc<node>&
   get_allocator() const {
     return alloc_;
@@ -214,42 +519,243 @@ class List {
     }
   }
 
-  template <typename... Args>
-  void construct_node_back(node* new_node, Args&&... args) {
-    alloc_traits::construct(alloc_, new_node, new_node, new_node,
-                            std::forward<Args>(args)...);
-    add_node_back(new_node);
+  // Сторожевой узел: end() и соседи крайних элементов.
+  node* sentinel() const {
+    return static_cast<node*>(const_cast<fake_node*>(&fake_));
   }
 
-  void add_node_back(node* new_node) {
+  // Первый элемент; у списка, в который ещё ничего не клали, ссылки
+  // fake_ пусты, и это сторож.
+  node* first_node() const {
+    return fake_.next != nullptr ? fake_.next : sentinel();
+  }
+
+  void init_fake() noexcept {
     if ((&fake_)->prev == nullptr) {
       (&fake_)->prev = static_cast<node*>(&fake_);
     }
     if ((&fake_)->next == nullptr) {
       (&fake_)->next = static_cast<node*>(&fake_);
     }
-    new_node->prev = (&fake_)->prev;
-    new_node->next = static_cast<node*>(&fake_);
-    (&fake_)->prev->next = new_node;
-    (&fake_)->prev = new_node;
-    now_sz_++;
   }
 
+  template <typename... Args>
+  void construct_node_back(node* new_node, Args&&... args) {
+    construct_node_before(sentinel(), new_node, std::forward<Args>(args)...);
+  }
+
+  void add_node_back(node* new_node) { add_node_before(sentinel(), new_node); }
+
   template <typename... Args>
   void construct_node_front(node* new_node, Args&&... args) {
+    init_fake();
+    construct_node_before((&fake_)->next, new_node,
+                          std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  void construct_node_before(node* pos, node* new_node, Args&&... args) {
     alloc_traits::construct(alloc_, new_node, new_node, new_node,
                             std::forward<Args>(args)...);
-    if ((&fake_)->next == nullptr) {
-      (&fake_)->next = static_cast<node*>(&fake_);
+    add_node_before(pos, new_node);
+  }
+
+  void add_node_before(node* pos, node* new_node) {
+    init_fake();
+    new_node->prev = pos->prev;
+    new_node->next = pos;
+    pos->prev->next = new_node;
+    pos->prev = new_node;
+    now_sz_++;
+  }
+
+  void unlink_node(node* old_node) {
+    old_node->prev->next = old_node->next;
+    old_node->next->prev = old_node->prev;
+    --now_sz_;
+  }
+
+  void destroy_node(node* old_node) {
+    unlink_node(old_node);
+    alloc_traits::destroy(alloc_, old_node);
+    alloc_traits::deallocate(alloc_, old_node, 1);
+  }
+
+  // Уничтожает узлы, сцепленные через next (уже вынутые из списка).
+  void free_chain(node* chain) {
+    while (chain != nullptr) {
+      node* next = chain->next;
+      alloc_traits::destroy(alloc_, chain);
+      alloc_traits::deallocate(alloc_, chain, 1);
+      chain = next;
     }
-    if ((&fake_)->prev == nullptr) {
-      (&fake_)->prev = static_cast<node*>(&fake_);
+  }
+
+  // Обменивает узлы и размеры списков; аллокаторы не трогает.
+  void swap_nodes(List& other) noexcept {
+    init_fake();
+    other.init_fake();
+    std::swap((&fake_)->next, (&other.fake_)->next);
+    std::swap((&fake_)->prev, (&other.fake_)->prev);
+    std::swap(now_sz_, other.now_sz_);
+    relink_fake();
+    other.relink_fake();
+  }
+
+  // Направляет крайние узлы на свой fake_ (после обмена ссылками).
+  void relink_fake() noexcept {
+    if (now_sz_ == 0) {
+      (&fake_)->next = (&fake_)->prev = sentinel();
+      return;
     }
-    new_node->next = (&fake_)->next;
-    new_node->prev = static_cast<node*>(&fake_);
-    (&fake_)->next->prev = new_node;
-    (&fake_)->next = new_node;
-    now_sz_++;
+    (&fake_)->next->prev = sentinel();
+    (&fake_)->prev->next = sentinel();
+  }
+
+  // Вынимает узлы из кольца: они остаются цепочкой по next от первого до
+  // последнего, оканчивающейся nullptr. Размер не меняется.
+  node* detach_chain() {
+    node* head = (&fake_)->next;
+    (&fake_)->prev->next = nullptr;
+    return head;
+  }
+
+  // Возвращает цепочку по next в кольцо, восстанавливая ссылки prev.
+  void attach_chain(node* head) noexcept {
+    node* prev = sentinel();
+    for (node* curr = head; curr != nullptr; curr = curr->next) {
+      curr->prev = prev;
+      prev = curr;
+    }
+    prev->next = sentinel();
+    (&fake_)->next = head != nullptr ? head : sentinel();
+    (&fake_)->prev = prev;
+  }
+
+  // Сливает цепочки left и right (по next, оканчиваются nullptr) в head;
+  // из равных элементов раньше идут узлы left. Если comp бросает, остатки
+  // цепочек приклеиваются как есть, и от head по-прежнему достижимы все
+  // узлы.
+  template <typename Compare>
+  static void merge_chains(node*& head, node* left, node* right,
+                           Compare& comp) {
+    node* tail = nullptr;
+    auto append = [&head, &tail](node* item) {
+      (tail != nullptr ? tail->next : head) = item;
+      tail = item;
+    };
+    try {
+      while (left != nullptr && right != nullptr) {
+        if (comp(right->value, left->value)) {
+          append(right);
+          right = right->next;
+        } else {
+          append(left);
+          left = left->next;
+        }
+      }
+    } catch (...) {
+      append(left);
+      while (tail->next != nullptr) {
+        tail = tail->next;
+      }
+      tail->next = right;
+      throw;
+    }
+    (tail != nullptr ? tail->next : head) = left != nullptr ? left : right;
+  }
+
+  // Сортирует цепочку по next, оканчивающуюся nullptr. Узлы по одному
+  // проталкиваются через ячейки bins: в bins[i] лежит отсортированная
+  // цепочка из 2^i узлов, две цепочки одной длины сливаются и переходят
+  // ячейкой выше. Так сливаются ещё горячие в кэше короткие куски, а
+  // памяти нужно 64 указателя при любой длине.
+  template <typename Compare>
+  static void sort_chain(node*& head, Compare& comp) {
+    node* bins[64] = {};
+    node* carry = nullptr;
+    node* rest = head;
+    try {
+      while (rest != nullptr) {
+        carry = rest;
+        rest = rest->next;
+        carry->next = nullptr;
+        size_t level = 0;
+        for (; bins[level] != nullptr; ++level) {
+          node* left = std::exchange(bins[level], nullptr);
+          merge_chains(carry, left, std::exchange(carry, nullptr), comp);
+        }
+        bins[level] = std::exchange(carry, nullptr);
+      }
+      for (node*& bin : bins) {
+        if (bin != nullptr) {
+          node* left = std::exchange(bin, nullptr);
+          merge_chains(carry, left, std::exchange(carry, nullptr), comp);
+        }
+      }
+    } catch (...) {
+      // Каждый узел сейчас ровно в одной из цепочек carry, bins и rest.
+      head = rest;
+      for (node* chain : bins) {
+        prepend_chain(head, chain);
+      }
+      prepend_chain(head, carry);
+      throw;
+    }
+    head = carry;
+  }
+
+  // Ставит цепочку chain перед цепочкой head.
+  static void prepend_chain(node*& head, node* chain) {
+    if (chain == nullptr) {
+      return;
+    }
+    node* last = chain;
+    while (last->next != nullptr) {
+      last = last->next;
+    }
+    last->next = head;
+    head = chain;
+  }
+
+  // Вызывает func(t) для t из [0, tasks) в разных потоках (t == 0 - в
+  // текущем) и возвращает первое исключение.
+  template <typename Func>
+  static std::exception_ptr run_parallel(size_t tasks, Func func) {
+    std::vector<std::exception_ptr> errors(tasks);
+    auto guarded = [&func, &errors](size_t task) {
+      try {
+        func(task);
+      } catch (...) {
+        errors[task] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> workers;
+    for (size_t task = 1; task < tasks; ++task) {
+      workers.emplace_back(guarded, task);
+    }
+    guarded(0);
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    for (std::exception_ptr& error : errors) {
+      if (error) {
+        return error;
+      }
+    }
+    return nullptr;
+  }
+
+  // Переносит узлы [first, last) (возможно, из другого списка) перед pos.
+  // Размеры списков не меняет.
+  static void transfer(node* pos, node* first, node* last) {
+    node* tail = last->prev;
+    first->prev->next = last;
+    last->prev = first->prev;
+    first->prev = pos->prev;
+    tail->next = pos;
+    pos->prev->next = first;
+    pos->prev = tail;
   }
 };
 
@@ -269,17 +775,19 @@ struct List<T, Allocator>::node : public fake_node {
 
   node() : fake_node(nullptr, nullptr) {}
 
-  node(node* prev_2, node* next_2, T&& value_2)
-      : fake_node(prev_2, next_2), value((value_2)) {}
-
-  node(node* prev_2, node* next_2, const T& value_2)
-      : fake_node(prev_2, next_2), value(value_2) {}
+  template <typename... Args>
+  node(node* prev_2, node* next_2, Args&&... args)
+      : fake_node(prev_2, next_2), value(std::forward<Args>(args)...) {}
 };
 
 template <typename T, typename Allocator>
 template <bool IsConst>
 class List<T, Allocator>::common_iterator {
  private:
+  friend class List;
+  template <bool>
+  friend class common_iterator;
+
   node* curr_;
 
  public:
@@ -296,8 +804,14 @@ class List<T, Allocator>::common_iterator {
 
   common_iterator(const common_iterator& other) : curr_(other.curr_) {}
 
+  template <bool IsOtherConst>
+    requires(IsConst && !IsOtherConst)
+  common_iterator(const common_iterator<IsOtherConst>& other)
+      : curr_(other.curr_) {}
+
   common_iterator& operator=(const common_iterator& other) {
     curr_ = other.curr_;
+    return *this;
   }
 
   reference operator*() { return curr_->value; }
@@ -0,0 +1,266 @@
+// Бенчмарки списка: List на std::allocator против List на PoolAllocator,
+// UnrolledList и std::list. Результат - JSON, чтобы сравнивать прогоны
+// между версиями.
+//
+//   list_benchmark [--ops N] [--out file.json]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../Benchmark/benchmark.hpp"
+#include "../Benchmark/heap_counter.hpp"
+#include "list.hpp"
+#include "pool_allocator.hpp"
+#include "unrolled_list.hpp"
+
+namespace {
+
+BenchmarkRow Row(const std::string& name, const std::string& container,
+                 size_t size) {
+  return BenchmarkRow()
+      .Add("name", name)
+      .Add("container", container)
+      .Add("size", size);
+}
+
+template <typename Container>
+uint64_t Sum(const Container& list) {
+  uint64_t sum = 0;
+  for (auto iter = list.begin(); iter != list.end(); ++iter) {
+    sum += *iter;
+  }
+  return sum;
+}
+
+// rounds раз строится список из size элементов push_back'ами.
+template <typename Container>
+BenchmarkRow RunPushBack(const std::string& container, size_t size,
+                         uint64_t rounds) {
+  HeapMeter meter;
+  for (uint64_t round = 0; round < rounds; ++round) {
+    Container list;
+    for (size_t ind = 0; ind < size; ++ind) {
+      list.push_back(ind);
+    }
+    sink = list.size();
+  }
+  meter.Stop();
+  return meter.PerOp(Row("push_back", container, size), rounds * size);
+}
+
+// Книга заявок: levels списков-уровней, в случайный уровень добавляется
+// заявка, из случайного уровня снимается самая старая. После ops таких
+// шагов узлы каждого уровня на std::allocator разбросаны по куче; замер -
+// обход всех уровней.
+template <typename Container>
+std::vector<BenchmarkRow> RunOrderBook(const std::string& container,
+                                       size_t levels, size_t orders,
+                                       uint64_t ops, uint64_t walks) {
+  std::vector<Container> book(levels);
+  std::mt19937_64 rng(42);
+  HeapMeter churn;
+  for (size_t ind = 0; ind < orders; ++ind) {
+    book[rng() % levels].push_back(ind);
+  }
+  for (uint64_t ind = 0; ind < ops; ++ind) {
+    book[rng() % levels].push_back(ind);
+    Container& level = book[rng() % levels];
+    if (!level.empty()) {
+      level.pop_front();
+    }
+  }
+  churn.Stop();
+
+  size_t total = 0;
+  for (const Container& level : book) {
+    total += level.size();
+  }
+  HeapMeter walked;
+  for (uint64_t walk = 0; walk < walks; ++walk) {
+    uint64_t sum = 0;
+    for (const Container& level : book) {
+      sum += Sum(level);
+    }
+    sink = sum;
+  }
+  walked.Stop();
+  return {churn.PerOp(Row("order_book_churn", container, total), orders + ops),
+          walked.PerOp(Row("order_book_traversal", container, total),
+                       walks * total)};
+}
+
+// Список, принятый по значению, возвращается обратно: конструктор
+// перемещения вызывается и на входе, и на выходе.
+template <typename Container>
+Container PassThrough(Container list) {
+  return list;
+}
+
+// count списков по size элементов rounds раз проходят через PassThrough
+// и присваиваются на место. Перемещение не должно ходить в кучу.
+template <typename Container>
+BenchmarkRow RunReturnByValue(const std::string& container, size_t count,
+                              size_t size, uint64_t rounds) {
+  std::vector<Container> lists(count);
+  for (Container& list : lists) {
+    for (size_t ind = 0; ind < size; ++ind) {
+      list.push_back(ind);
+    }
+  }
+  HeapMeter meter;
+  for (uint64_t round = 0; round < rounds; ++round) {
+    for (Container& list : lists) {
+      list = PassThrough(std::move(list));
+    }
+  }
+  meter.Stop();
+  sink = lists.back().size();
+  return meter.PerOp(Row("return_by_value", container, size), rounds * count);
+}
+
+// Сортировка списка из size случайных чисел; threads == 0 - обычный sort(),
+// иначе параллельный режим List::sort.
+template <typename Container>
+BenchmarkRow RunSort(const std::string& container, size_t size,
+                     size_t threads) {
+  Container list;
+  std::mt19937_64 rng(42);
+  for (size_t ind = 0; ind < size; ++ind) {
+    list.push_back(rng());
+  }
+  HeapMeter meter;
+  if constexpr (std::is_same_v<Container, std::list<uint64_t>>) {
+    list.sort();
+  } else {
+    if (threads == 0) {
+      list.sort();
+    } else {
+      list.sort(std::less<>(), threads);
+    }
+  }
+  meter.Stop();
+  if (!std::is_sorted(list.begin(), list.end())) {
+    std::cerr << "sort mismatch\n";
+    std::exit(1);
+  }
+  std::string name =
+      threads == 0 ? "sort" : "sort_threads_" + std::to_string(threads);
+  return meter.PerOp(Row(name, container, size), size);
+}
+
+// Список из size элементов, rounds полных обходов.
+template <typename Container>
+BenchmarkRow RunTraversal(const std::string& container, size_t size,
+                          uint64_t rounds) {
+  Container list;
+  for (size_t ind = 0; ind < size; ++ind) {
+    list.push_back(ind);
+  }
+  HeapMeter meter;
+  for (uint64_t round = 0; round < rounds; ++round) {
+    sink = Sum(list);
+  }
+  meter.Stop();
+  return meter.PerOp(Row("traversal", container, size), rounds * size);
+}
+
+// ops вставок в середину списка из size элементов: итератор, который
+// вернула вставка, служит позицией следующей, через раз сдвигаясь вперёд.
+template <typename Container>
+BenchmarkRow RunMiddleInsert(const std::string& container, size_t size,
+                             uint64_t ops) {
+  Container list;
+  for (size_t ind = 0; ind < size; ++ind) {
+    list.push_back(ind);
+  }
+  auto iter = list.begin();
+  for (size_t ind = 0; ind < size / 2; ++ind) {
+    ++iter;
+  }
+  HeapMeter meter;
+  for (uint64_t ind = 0; ind < ops; ++ind) {
+    iter = list.insert(iter, ind);
+    if (ind % 2 == 1) {
+      ++iter;
+    }
+  }
+  meter.Stop();
+  sink = Sum(list);
+  return meter.PerOp(Row("middle_insert", container, size), ops);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkArgs args(argc, argv);
+  uint64_t ops = args.Number("--ops", 1'000'000);
+
+  using StdList = List<uint64_t>;
+  using PoolList = List<uint64_t, PoolAllocator<uint64_t>>;
+  using Unrolled = UnrolledList<uint64_t>;
+  std::vector<BenchmarkRow> results;
+  for (size_t size : {1'000, 1'000'000}) {
+    uint64_t rounds = std::max<uint64_t>(ops / size, 1);
+    results.push_back(RunPushBack<StdList>("List", size, rounds));
+    results.push_back(
+        RunPushBack<PoolList>("List+PoolAllocator", size, rounds));
+    results.push_back(RunPushBack<Unrolled>("UnrolledList", size, rounds));
+    results.push_back(
+        RunPushBack<std::list<uint64_t>>("std::list", size, rounds));
+  }
+
+  const size_t levels = 64;
+  const size_t orders = 200'000;
+  uint64_t walks = std::max<uint64_t>(ops / orders, 1);
+  auto add = [&results](std::vector<BenchmarkRow> rows) {
+    results.insert(results.end(), rows.begin(), rows.end());
+  };
+  add(RunOrderBook<StdList>("List", levels, orders, ops, walks));
+  add(RunOrderBook<PoolList>("List+PoolAllocator", levels, orders, ops,
+                             walks));
+  add(RunOrderBook<Unrolled>("UnrolledList", levels, orders, ops, walks));
+  add(RunOrderBook<std::list<uint64_t>>("std::list", levels, orders, ops,
+                                        walks));
+
+  const size_t walk_size = 1'000'000;
+  uint64_t walk_rounds = std::max<uint64_t>(ops / walk_size, 1) * 10;
+  results.push_back(RunTraversal<StdList>("List", walk_size, walk_rounds));
+  results.push_back(
+      RunTraversal<Unrolled>("UnrolledList", walk_size, walk_rounds));
+  results.push_back(RunTraversal<std::list<uint64_t>>("std::list", walk_size,
+                                                      walk_rounds));
+
+  const size_t insert_size = 100'000;
+  results.push_back(RunMiddleInsert<StdList>("List", insert_size, ops));
+  results.push_back(
+      RunMiddleInsert<Unrolled>("UnrolledList", insert_size, ops));
+  results.push_back(RunMiddleInsert<std::list<uint64_t>>(
+      "std::list", insert_size, ops));
+
+  const size_t lists = 16;
+  const size_t list_size = 100'000;
+  uint64_t passes = std::max<uint64_t>(ops / lists, 1);
+  results.push_back(
+      RunReturnByValue<StdList>("List", lists, list_size, passes));
+  results.push_back(RunReturnByValue<std::list<uint64_t>>(
+      "std::list", lists, list_size, passes));
+
+  const size_t sort_size = 1'000'000;
+  results.push_back(RunSort<StdList>("List", sort_size, 0));
+  for (size_t threads = 2; threads <= std::thread::hardware_concurrency();
+       threads *= 2) {
+    results.push_back(RunSort<StdList>("List", sort_size, threads));
+  }
+  results.push_back(RunSort<std::list<uint64_t>>("std::list", sort_size, 0));
+
+  WriteBenchmarkJson(args.OutPath(), "list", results);
+  return 0;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Размер куска памяти, из которого арена нарезает объекты.
+inline constexpr size_t kPoolSlabBytes = 64 * 1024;
+
+// Объекты крупнее этого арена не нарезает, а берёт у operator new.
+inline constexpr size_t kPoolMaxObjectBytes = kPoolSlabBytes / 16;
+
+// Арена для объектов фиксированного размера (узлов списка): объекты
+// нарезаются подряд из больших кусков (slab'ов), освобождённые попадают в
+// список свободных своего размера и отдаются следующему allocate. Куски
+// возвращаются системе только все сразу - release() или деструктором.
+// Не потокобезопасна.
+class PoolArena {
+ public:
+  PoolArena() = default;
+
+  PoolArena(const PoolArena&) = delete;
+  PoolArena& operator=(const PoolArena&) = delete;
+
+  ~PoolArena() { release(); }
+
+  void* allocate(size_t bytes, size_t align) {
+    if (bytes > kPoolMaxObjectBytes ||
+        align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return ::operator new(bytes, std::align_val_t(align));
+    }
+    size_class& cls = class_of(bytes);
+    if (cls.free != nullptr) {
+      free_slot* slot = cls.free;
+      cls.free = slot->next;
+      return slot;
+    }
+    if (cls.cursor == cls.limit) {
+      char* slab = static_cast<char*>(::operator new(kPoolSlabBytes));
+      slabs_.push_back(slab);
+      cls.cursor = slab;
+      cls.limit = slab + kPoolSlabBytes / cls.size * cls.size;
+    }
+    void* place = cls.cursor;
+    cls.cursor += cls.size;
+    return place;
+  }
+
+  void deallocate(void* ptr, size_t bytes, size_t align) noexcept {
+    if (bytes > kPoolMaxObjectBytes ||
+        align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(ptr, std::align_val_t(align));
+      return;
+    }
+    size_class& cls = class_of(bytes);
+    cls.free = new (ptr) free_slot{cls.free};
+  }
+
+  // Возвращает системе все куски разом. Объекты, выделенные из арены,
+  // после этого использовать нельзя.
+  void release() noexcept {
+    for (char* slab : slabs_) {
+      ::operator delete(slab);
+    }
+    slabs_.clear();
+    classes_.clear();
+  }
+
+  size_t slabs() const { return slabs_.size(); }
+
+ private:
+  struct free_slot {
+    free_slot* next;
+  };
+
+  struct size_class {
+    size_t size;
+    free_slot* free = nullptr;  // освобождённые объекты
+    char* cursor = nullptr;     // ещё не выданная часть текущего куска
+    char* limit = nullptr;
+  };
+
+  // Размеров обычно один-два (узел списка), поэтому поиск линейный.
+  std::vector<size_class> classes_;
+  std::vector<char*> slabs_;
+
+  size_class& class_of(size_t bytes) {
+    constexpr size_t kGrain = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    size_t size = std::max((bytes + kGrain - 1) / kGrain * kGrain, kGrain);
+    for (size_class& cls : classes_) {
+      if (cls.size == size) {
+        return cls;
+      }
+    }
+    return classes_.emplace_back(size_class{size});
+  }
+};
+
+// Аллокатор поверх PoolArena: List<T, PoolAllocator<T>> берёт узлы из
+// кусков своей арены, а не по одному у malloc. Копии аллокатора (в том
+// числе rebind к типу узла) делят одну арену, арена живёт, пока жива хоть
+// одна копия. Копия контейнера получает новую арену; при перемещении и
+// обмене арена переходит вместе с узлами. Перемещение аллокатора - это
+// копирование: контейнер, из которого переместили, сохраняет арену и
+// может выделять память дальше.
+template <typename T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  PoolAllocator() : arena_(std::make_shared<PoolArena>()) {}
+
+  explicit PoolAllocator(std::shared_ptr<PoolArena> arena)
+      : arena_(std::move(arena)) {}
+
+  // Без перемещающих версий: неявное перемещение оставило бы arena_ пустым.
+  PoolAllocator(const PoolAllocator&) noexcept = default;
+  PoolAllocator& operator=(const PoolAllocator&) noexcept = default;
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>& other) noexcept
+      : arena_(other.arena_) {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(
+        arena_->allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* ptr, size_t count) noexcept {
+    arena_->deallocate(ptr, count * sizeof(T), alignof(T));
+  }
+
+  PoolAllocator select_on_container_copy_construction() const {
+    return PoolAllocator();
+  }
+
+  PoolArena& arena() const { return *arena_; }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>& other) const {
+    return arena_ == other.arena_;
+  }
+
+ private:
+  template <typename U>
+  friend class PoolAllocator;
+
+  std::shared_ptr<PoolArena> arena_;
+};
@@ -0,0 +1,78 @@
+// Проверки PoolAllocator: контейнер, из которого переместили, продолжает
+// выделять память из своей арены.
+//
+//   pool_allocator_test
+
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "list.hpp"
+#include "pool_allocator.hpp"
+
+namespace {
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::cerr << what << " failed\n";
+    std::exit(1);
+  }
+}
+
+void TestAllocatorMove() {
+  PoolAllocator<int> source;
+  PoolAllocator<int> moved(std::move(source));
+  Check(moved == source, "moved allocator shares the arena");
+  int* ptr = source.allocate(1);
+  source.deallocate(ptr, 1);
+
+  PoolAllocator<int> assigned;
+  assigned = std::move(moved);
+  Check(assigned == moved, "move-assigned allocator shares the arena");
+  ptr = moved.allocate(1);
+  moved.deallocate(ptr, 1);
+}
+
+void TestVectorMove() {
+  std::vector<int, PoolAllocator<int>> source = {1};
+  std::vector<int, PoolAllocator<int>> moved(std::move(source));
+  source.push_back(2);
+  Check(source.size() == 1 && source[0] == 2, "vector move construction");
+
+  std::vector<int, PoolAllocator<int>> assigned;
+  assigned = std::move(moved);
+  moved.push_back(3);
+  Check(moved.size() == 1 && moved[0] == 3, "vector move assignment");
+  Check(assigned.size() == 1 && assigned[0] == 1, "vector moved contents");
+}
+
+void TestListMove() {
+  using PoolList = List<int, PoolAllocator<int>>;
+  PoolList source;
+  source.push_back(1);
+  PoolList moved(std::move(source));
+  source.push_back(2);
+  Check(source.size() == 1 && *source.begin() == 2, "list move construction");
+
+  PoolList assigned;
+  assigned = std::move(moved);
+  moved.push_back(3);
+  Check(moved.size() == 1 && *moved.begin() == 3, "list move assignment");
+  Check(assigned.size() == 1 && *assigned.begin() == 1, "list moved contents");
+
+  swap(source, assigned);
+  source.push_back(4);
+  assigned.push_back(5);
+  Check(source.size() == 2 && assigned.size() == 2, "list swap");
+}
+
+}  // namespace
+
+int main() {
+  TestAllocatorMove();
+  TestVectorMove();
+  TestListMove();
+  std::cout << "ok\n";
+  return 0;
+}
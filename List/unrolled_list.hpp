@@ -0,0 +1,473 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Сколько байт элементов лежит в одном узле развёрнутого списка по
+// умолчанию: несколько кэш-линий.
+inline constexpr size_t kUnrolledChunkBytes = 256;
+
+constexpr size_t UnrolledChunkSize(size_t elem_size) {
+  return std::max<size_t>(kUnrolledChunkBytes / elem_size, 4);
+}
+
+// Развёрнутый список: как List, но в каждом узле лежат до kChunkSize
+// элементов подряд и их число. Обход идёт по массиву внутри узла, а пара
+// указателей и выделение памяти приходятся на узел, а не на элемент.
+//
+// Вставка и удаление сдвигают элементы только внутри своего узла:
+// переполненный узел делится пополам, опустевший освобождается, а почти
+// пустой сливается со следующим. Итераторы на элементы узлов, которых
+// операция не коснулась, остаются действительными.
+template <typename T, typename Allocator = std::allocator<T>,
+          size_t kChunkSize = UnrolledChunkSize(sizeof(T))>
+class UnrolledList {
+  static_assert(kChunkSize >= 2, "chunk must hold at least two elements");
+
+ public:
+  struct fake_chunk;
+  struct chunk;
+
+  template <bool IsConst>
+  class common_iterator;
+
+  using iterator = common_iterator<false>;
+  using const_iterator = common_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  using allocator_type = Allocator;
+  using chunk_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<chunk>;
+  using alloc_traits = std::allocator_traits<chunk_allocator>;
+  using value_type = T;
+
+  UnrolledList() { reset_fake(); }
+
+  explicit UnrolledList(const Allocator& alloc) : alloc_(alloc) {
+    reset_fake();
+  }
+
+  UnrolledList(std::initializer_list<T> init,
+               const Allocator& alloc = Allocator())
+      : alloc_(alloc) {
+    reset_fake();
+    append_all(init.begin(), init.end());
+  }
+
+  UnrolledList(const UnrolledList& other)
+      : alloc_(alloc_traits::select_on_container_copy_construction(
+            other.alloc_)) {
+    reset_fake();
+    append_all(other.cbegin(), other.cend());
+  }
+
+  UnrolledList(UnrolledList&& other) noexcept : alloc_(other.alloc_) {
+    reset_fake();
+    swap_chunks(other);
+  }
+
+  ~UnrolledList() { clear(); }
+
+  UnrolledList& operator=(const UnrolledList& other) {
+    bool propagate =
+        alloc_traits::propagate_on_container_copy_assignment::value &&
+        alloc_ != other.alloc_;
+    UnrolledList copy(propagate ? other.alloc_ : alloc_);
+    copy.append_all(other.cbegin(), other.cend());
+    if (propagate) {
+      std::swap(alloc_, copy.alloc_);
+    }
+    swap_chunks(copy);
+    return *this;
+  }
+
+  UnrolledList& operator=(UnrolledList&& other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                      value) {
+      alloc_ = other.alloc_;
+      swap_chunks(other);
+    } else if (alloc_ == other.alloc_) {
+      swap_chunks(other);
+    } else {
+      for (T& value : other) {
+        emplace_back(std::move(value));
+      }
+      other.clear();
+    }
+    return *this;
+  }
+
+  void swap(UnrolledList& other) noexcept {
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+      using std::swap;
+      swap(alloc_, other.alloc_);
+    }
+    swap_chunks(other);
+  }
+
+  friend void swap(UnrolledList& first, UnrolledList& second) noexcept {
+    first.swap(second);
+  }
+
+  iterator begin() { return iterator(fake_.next, 0); }
+
+  iterator end() { return iterator(sentinel(), 0); }
+
+  const_iterator begin() const { return const_iterator(fake_.next, 0); }
+
+  const_iterator end() const { return const_iterator(sentinel(), 0); }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator cend() const { return end(); }
+
+  reverse_iterator rbegin() { return std::make_reverse_iterator(end()); }
+
+  reverse_iterator rend() { return std::make_reverse_iterator(begin()); }
+
+  const_reverse_iterator rbegin() const {
+    return std::make_reverse_iterator(end());
+  }
+
+  const_reverse_iterator rend() const {
+    return std::make_reverse_iterator(begin());
+  }
+
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  const_reverse_iterator crend() const { return rend(); }
+
+  T& front() { return *fake_.next->at(0); }
+
+  const T& front() const { return *fake_.next->at(0); }
+
+  T& back() { return *fake_.prev->at(fake_.prev->count - 1); }
+
+  const T& back() const { return *fake_.prev->at(fake_.prev->count - 1); }
+
+  bool empty() const { return now_sz_ == 0; }
+
+  size_t size() const { return now_sz_; }
+
+  // Число узлов; вместе с size() показывает, насколько узлы заполнены.
+  size_t chunk_count() const { return chunks_; }
+
+  void push_back(const T& value) { emplace_back(value); }
+
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  void push_front(const T& value) { emplace_front(value); }
+
+  void push_front(T&& value) { emplace_front(std::move(value)); }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    chunk* last = fake_.prev;
+    if (last == sentinel() || last->count == kChunkSize) {
+      last = add_chunk_after(last);
+    }
+    try {
+      alloc_traits::construct(alloc_, last->at(last->count),
+                              std::forward<Args>(args)...);
+    } catch (...) {
+      if (last->count == 0) {
+        free_chunk(last);
+      }
+      throw;
+    }
+    ++last->count;
+    ++now_sz_;
+    return *last->at(last->count - 1);
+  }
+
+  template <typename... Args>
+  T& emplace_front(Args&&... args) {
+    return *emplace(cbegin(), std::forward<Args>(args)...);
+  }
+
+  void pop_back() { erase(std::prev(cend())); }
+
+  void pop_front() { erase(cbegin()); }
+
+  // Создаёт элемент перед pos и возвращает итератор на него. Вставка
+  // перед первым элементом узла идёт в конец предыдущего узла, если там
+  // есть место, иначе элементы узла сдвигаются (а полный узел сначала
+  // делится пополам).
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    chunk* curr = pos.chunk_;
+    size_t index = pos.index_;
+    if (index == 0 && curr->prev != sentinel() &&
+        curr->prev->count < kChunkSize) {
+      curr = curr->prev;
+      index = curr->count;
+    } else if (curr == sentinel()) {
+      emplace_back(std::forward<Args>(args)...);
+      return std::prev(end());
+    }
+    if (index == curr->count) {
+      alloc_traits::construct(alloc_, curr->at(index),
+                              std::forward<Args>(args)...);
+    } else {
+      T value(std::forward<Args>(args)...);
+      if (curr->count == kChunkSize) {
+        split(curr);
+        if (index > curr->count) {
+          index -= curr->count;
+          curr = curr->next;
+        }
+      }
+      if (index == curr->count) {
+        alloc_traits::construct(alloc_, curr->at(index), std::move(value));
+      } else {
+        T* items = curr->at(0);
+        alloc_traits::construct(alloc_, items + curr->count,
+                                std::move(items[curr->count - 1]));
+        std::move_backward(items + index, items + curr->count - 1,
+                           items + curr->count);
+        items[index] = std::move(value);
+      }
+    }
+    ++curr->count;
+    ++now_sz_;
+    return iterator(curr, index);
+  }
+
+  iterator insert(const_iterator pos, const T& value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  // Удаляет элемент pos и возвращает итератор на следующий. Опустевший
+  // узел освобождается; если узел вместе со следующим занимает не больше
+  // половины узла, следующий переливается в него.
+  iterator erase(const_iterator pos) {
+    chunk* curr = pos.chunk_;
+    size_t index = pos.index_;
+    T* items = curr->at(0);
+    std::move(items + index + 1, items + curr->count, items + index);
+    alloc_traits::destroy(alloc_, items + curr->count - 1);
+    --curr->count;
+    --now_sz_;
+    if (curr->count == 0) {
+      chunk* next = curr->next;
+      free_chunk(curr);
+      return iterator(next, 0);
+    }
+    chunk* next = curr->next;
+    if (next != sentinel() && curr->count + next->count <= kChunkSize / 2) {
+      T* from = next->at(0);
+      for (size_t ind = 0; ind < next->count; ++ind) {
+        alloc_traits::construct(alloc_, items + curr->count,
+                                std::move(from[ind]));
+        alloc_traits::destroy(alloc_, from + ind);
+        ++curr->count;
+      }
+      next->count = 0;
+      free_chunk(next);
+    }
+    if (index == curr->count) {
+      return iterator(curr->next, 0);
+    }
+    return iterator(curr, index);
+  }
+
+  void clear() noexcept {
+    chunk* curr = fake_.next;
+    while (curr != sentinel()) {
+      chunk* next = curr->next;
+      for (size_t ind = 0; ind < curr->count; ++ind) {
+        alloc_traits::destroy(alloc_, curr->at(ind));
+      }
+      alloc_traits::destroy(alloc_, curr);
+      alloc_traits::deallocate(alloc_, curr, 1);
+      curr = next;
+    }
+    reset_fake();
+    now_sz_ = 0;
+    chunks_ = 0;
+  }
+
+  const chunk_allocator& get_allocator() const { return alloc_; }
+
+ private:
+  fake_chunk fake_;
+  size_t now_sz_ = 0;
+  size_t chunks_ = 0;
+  chunk_allocator alloc_;
+
+  chunk* sentinel() const {
+    return static_cast<chunk*>(const_cast<fake_chunk*>(&fake_));
+  }
+
+  void reset_fake() noexcept { fake_.next = fake_.prev = sentinel(); }
+
+  template <typename Iter>
+  void append_all(Iter first, Iter last) {
+    try {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+
+  // Новый пустой узел после prev (sentinel() - в начало списка).
+  chunk* add_chunk_after(chunk* prev) {
+    chunk* new_chunk = alloc_traits::allocate(alloc_, 1);
+    alloc_traits::construct(alloc_, new_chunk);
+    new_chunk->prev = prev;
+    new_chunk->next = prev->next;
+    prev->next->prev = new_chunk;
+    prev->next = new_chunk;
+    ++chunks_;
+    return new_chunk;
+  }
+
+  // Вынимает и освобождает узел; его элементы уже уничтожены.
+  void free_chunk(chunk* old_chunk) noexcept {
+    old_chunk->prev->next = old_chunk->next;
+    old_chunk->next->prev = old_chunk->prev;
+    alloc_traits::destroy(alloc_, old_chunk);
+    alloc_traits::deallocate(alloc_, old_chunk, 1);
+    --chunks_;
+  }
+
+  // Переносит верхнюю половину полного узла в новый узел за ним.
+  void split(chunk* full) {
+    chunk* upper = add_chunk_after(full);
+    size_t keep = full->count / 2;
+    T* items = full->at(0);
+    for (size_t ind = keep; ind < full->count; ++ind) {
+      alloc_traits::construct(alloc_, upper->at(upper->count),
+                              std::move(items[ind]));
+      ++upper->count;
+    }
+    for (size_t ind = keep; ind < full->count; ++ind) {
+      alloc_traits::destroy(alloc_, items + ind);
+    }
+    full->count = keep;
+  }
+
+  // Обменивает узлы и размеры списков; аллокаторы не трогает.
+  void swap_chunks(UnrolledList& other) noexcept {
+    std::swap(fake_, other.fake_);
+    std::swap(now_sz_, other.now_sz_);
+    std::swap(chunks_, other.chunks_);
+    relink_fake();
+    other.relink_fake();
+  }
+
+  // Направляет крайние узлы на свой fake_ (после обмена ссылками).
+  void relink_fake() noexcept {
+    if (chunks_ == 0) {
+      reset_fake();
+      return;
+    }
+    fake_.next->prev = sentinel();
+    fake_.prev->next = sentinel();
+  }
+};
+
+template <typename T, typename Allocator, size_t kChunkSize>
+struct UnrolledList<T, Allocator, kChunkSize>::fake_chunk {
+  chunk* prev = nullptr;
+  chunk* next = nullptr;
+};
+
+template <typename T, typename Allocator, size_t kChunkSize>
+struct UnrolledList<T, Allocator, kChunkSize>::chunk : public fake_chunk {
+  size_t count = 0;
+  alignas(T) unsigned char storage[kChunkSize * sizeof(T)];
+
+  T* at(size_t index) { return reinterpret_cast<T*>(storage) + index; }
+};
+
+template <typename T, typename Allocator, size_t kChunkSize>
+template <bool IsConst>
+class UnrolledList<T, Allocator, kChunkSize>::common_iterator {
+ private:
+  friend class UnrolledList;
+  template <bool>
+  friend class common_iterator;
+
+  chunk* chunk_ = nullptr;
+  size_t index_ = 0;
+
+ public:
+  using type = std::conditional_t<IsConst, const T, T>;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = T;
+  using pointer = type*;
+  using reference = type&;
+  using difference_type = int64_t;
+
+  common_iterator() {}
+
+  common_iterator(chunk* owner, size_t index)
+      : chunk_(owner), index_(index) {}
+
+  template <bool IsOtherConst>
+    requires(IsConst && !IsOtherConst)
+  common_iterator(const common_iterator<IsOtherConst>& other)
+      : chunk_(other.chunk_), index_(other.index_) {}
+
+  reference operator*() const { return *chunk_->at(index_); }
+
+  pointer operator->() const { return chunk_->at(index_); }
+
+  common_iterator& operator++() {
+    if (++index_ == chunk_->count) {
+      chunk_ = chunk_->next;
+      index_ = 0;
+    }
+    return *this;
+  }
+
+  common_iterator operator++(int) {
+    common_iterator tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  common_iterator& operator--() {
+    if (index_ == 0) {
+      chunk_ = chunk_->prev;
+      index_ = chunk_->count;
+    }
+    --index_;
+    return *this;
+  }
+
+  common_iterator operator--(int) {
+    common_iterator tmp = *this;
+    --(*this);
+    return tmp;
+  }
+
+  bool operator==(const common_iterator& other) const {
+    return chunk_ == other.chunk_ && index_ == other.index_;
+  }
+
+  bool operator!=(const common_iterator& other) const {
+    return !(*this == other);
+  }
+};
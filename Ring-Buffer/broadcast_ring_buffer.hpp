@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "ring_buffer.hpp"
+
+// Рассылающий кольцевой буфер (в духе disruptor): один производитель
+// записывает каждую ячейку один раз, а каждый из consumers потребителей
+// читает все элементы по своему курсору. Производитель не обгоняет самого
+// медленного потребителя. Потребитель с номером id обращается к буферу
+// только из одного потока; разные потребители независимы.
+//
+// Ячейки создаются конструктором по умолчанию и переиспользуются
+// присваиванием, поэтому T должен быть конструируемым по умолчанию.
+template <typename T, size_t kCapacity = kDynamicCapacity>
+class BroadcastRingBuffer {
+ public:
+  explicit BroadcastRingBuffer(size_t consumers)
+    requires(kCapacity != kDynamicCapacity)
+      : cursors_(consumers) {
+    init_slots();
+  }
+
+  BroadcastRingBuffer(size_t capacity, size_t consumers)
+    requires(kCapacity == kDynamicCapacity)
+      : storage_(capacity), cursors_(consumers) {
+    init_slots();
+  }
+
+  BroadcastRingBuffer(const BroadcastRingBuffer&) = delete;
+  BroadcastRingBuffer& operator=(const BroadcastRingBuffer&) = delete;
+
+  ~BroadcastRingBuffer() {
+    for (size_t ind = 0; ind < storage_.Slots(); ++ind) {
+      std::destroy_at(storage_.Slot(ind));
+    }
+  }
+
+  size_t Capacity() const { return storage_.Capacity(); }
+
+  size_t Consumers() const { return cursors_.size(); }
+
+  // Вызывается только производителем.
+  template <typename U>
+  bool TryPush(U&& element) {
+    size_t end = end_.load(std::memory_order_relaxed);
+    if (end - cached_min_ == storage_.Capacity()) {
+      cached_min_ = slowest_position(end);
+      if (end - cached_min_ == storage_.Capacity()) {
+        return false;
+      }
+    }
+    *storage_.Slot(end) = std::forward<U>(element);
+    end_.store(end + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Сколько элементов ещё не прочитал потребитель id.
+  size_t Available(size_t id) {
+    Cursor& cursor = cursors_[id];
+    cursor.cached_end = end_.load(std::memory_order_acquire);
+    return cursor.cached_end -
+           cursor.position.load(std::memory_order_relaxed);
+  }
+
+  bool TryPop(size_t id, T* element) {
+    Cursor& cursor = cursors_[id];
+    size_t position = cursor.position.load(std::memory_order_relaxed);
+    if (position == cursor.cached_end && Available(id) == 0) {
+      return false;
+    }
+    *element = *storage_.Slot(position);
+    cursor.position.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Все доступные потребителю id элементы одним или двумя кусками. Пока
+  // CommitRead не вызван, производитель эти ячейки не трогает.
+  std::pair<std::span<const T>, std::span<const T>> ReadableSpans(size_t id) {
+    size_t count = Available(id);
+    const T* first =
+        storage_.Slot(cursors_[id].position.load(std::memory_order_relaxed));
+    size_t head = std::min(count, static_cast<size_t>(storage_.Slot(0) +
+                                                      storage_.Slots() - first));
+    return {std::span<const T>(first, head),
+            std::span<const T>(storage_.Slot(0), count - head)};
+  }
+
+  void CommitRead(size_t id, size_t count) {
+    Cursor& cursor = cursors_[id];
+    cursor.position.store(
+        cursor.position.load(std::memory_order_relaxed) + count,
+        std::memory_order_release);
+  }
+
+ private:
+  struct alignas(kCacheLineSize) Cursor {
+    std::atomic<size_t> position = 0;
+    size_t cached_end = 0;  // последнее увиденное потребителем значение end_
+  };
+
+  RingStorage<T, kCapacity> storage_;
+  std::vector<Cursor> cursors_;
+
+  // линия производителя
+  alignas(kCacheLineSize) std::atomic<size_t> end_ = 0;
+  size_t cached_min_ = 0;  // позиция самого медленного потребителя
+
+  void init_slots() {
+    for (size_t ind = 0; ind < storage_.Slots(); ++ind) {
+      std::construct_at(storage_.Slot(ind));
+    }
+  }
+
+  size_t slowest_position(size_t end) const {
+    size_t slowest = end;
+    for (const Cursor& cursor : cursors_) {
+      slowest =
+          std::min(slowest, cursor.position.load(std::memory_order_acquire));
+    }
+    return slowest;
+  }
+};
@@ -0,0 +1,160 @@
+// Проверки BroadcastRingBuffer: производитель ждёт самого медленного
+// потребителя, чтение кусками через ReadableSpans/CommitRead на стыке
+// кольца и рассылка всех элементов каждому потребителю из своего потока.
+//
+//   broadcast_ring_buffer_test [--ops N]
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "broadcast_ring_buffer.hpp"
+
+namespace {
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::cerr << what << " failed\n";
+    std::exit(1);
+  }
+}
+
+// Производитель кладёт, пока самый медленный потребитель не отстанет на
+// Capacity(); быстрый потребитель места не освобождает.
+void TestSlowestConsumerGates() {
+  BroadcastRingBuffer<uint64_t> buffer(5, 2);
+  for (uint64_t ind = 0; ind < 5; ++ind) {
+    Check(buffer.TryPush(ind), "push into free space");
+  }
+  Check(!buffer.TryPush(5), "push into full buffer");
+
+  uint64_t value;
+  for (uint64_t ind = 0; ind < 5; ++ind) {
+    Check(buffer.TryPop(0, &value) && value == ind, "fast consumer order");
+  }
+  Check(!buffer.TryPop(0, &value), "fast consumer drained");
+  Check(!buffer.TryPush(5), "push blocked by slow consumer");
+
+  Check(buffer.TryPop(1, &value) && value == 0, "slow consumer first");
+  Check(buffer.TryPush(5), "push after slow consumer moved");
+  Check(!buffer.TryPush(6), "push blocked again");
+  Check(buffer.Available(0) == 1 && buffer.Available(1) == 5,
+        "available per consumer");
+}
+
+// Собирает оба куска в один вектор.
+std::vector<uint64_t> Join(std::span<const uint64_t> head,
+                           std::span<const uint64_t> tail) {
+  std::vector<uint64_t> result(head.begin(), head.end());
+  result.insert(result.end(), tail.begin(), tail.end());
+  return result;
+}
+
+// Непрочитанные элементы переходят через конец кольца: ReadableSpans
+// отдаёт два куска, а CommitRead частью первого куска сдвигает оба.
+void TestSpansAcrossWrap() {
+  BroadcastRingBuffer<uint64_t> buffer(8, 1);
+  for (uint64_t ind = 0; ind < 6; ++ind) {
+    Check(buffer.TryPush(ind), "push before wrap");
+  }
+  auto [head, tail] = buffer.ReadableSpans(0);
+  Check(head.size() == 6 && tail.empty(), "spans before wrap");
+  buffer.CommitRead(0, 6);
+
+  for (uint64_t ind = 6; ind < 11; ++ind) {
+    Check(buffer.TryPush(ind), "push across wrap");
+  }
+  std::tie(head, tail) = buffer.ReadableSpans(0);
+  Check(head.size() == 2 && tail.size() == 3, "spans split at wrap");
+  Check(Join(head, tail) == std::vector<uint64_t>({6, 7, 8, 9, 10}),
+        "spans across wrap");
+
+  buffer.CommitRead(0, 1);
+  std::tie(head, tail) = buffer.ReadableSpans(0);
+  Check(Join(head, tail) == std::vector<uint64_t>({7, 8, 9, 10}),
+        "spans after partial commit");
+  buffer.CommitRead(0, 2);
+  std::tie(head, tail) = buffer.ReadableSpans(0);
+  Check(head.size() == 2 && tail.empty(), "spans after commit past wrap");
+  Check(Join(head, tail) == std::vector<uint64_t>({9, 10}),
+        "values after commit past wrap");
+
+  // Места освободилось ровно столько, сколько подтверждено.
+  for (uint64_t ind = 11; ind < 17; ++ind) {
+    Check(buffer.TryPush(ind), "push into committed space");
+  }
+  Check(!buffer.TryPush(17), "push past uncommitted elements");
+}
+
+// Каждый потребитель в своём потоке должен получить все элементы по
+// порядку; нечётные читают кусками и подтверждают их частями. Непрочитанных
+// никогда не больше Capacity().
+void TestConcurrentConsumers(size_t capacity, size_t consumers, uint64_t ops) {
+  BroadcastRingBuffer<uint64_t> buffer(capacity, consumers);
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < consumers; ++id) {
+    threads.emplace_back([&buffer, id, ops] {
+      uint64_t next = 0;
+      uint64_t value;
+      while (next < ops) {
+        Check(buffer.Available(id) <= buffer.Capacity(), "consumer lag");
+        if (id % 2 == 0) {
+          if (buffer.TryPop(id, &value)) {
+            Check(value == next++, "TryPop order");
+          } else {
+            std::this_thread::yield();
+          }
+          continue;
+        }
+        auto [head, tail] = buffer.ReadableSpans(id);
+        if (head.empty()) {
+          std::this_thread::yield();
+          continue;
+        }
+        // Подтверждается половина доступного, но хотя бы один элемент.
+        size_t count = (head.size() + tail.size() + 1) / 2;
+        for (size_t ind = 0; ind < count; ++ind) {
+          value = ind < head.size() ? head[ind] : tail[ind - head.size()];
+          Check(value == next++, "span order");
+        }
+        buffer.CommitRead(id, count);
+      }
+    });
+  }
+  for (uint64_t ind = 0; ind < ops;) {
+    if (buffer.TryPush(ind)) {
+      ++ind;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (size_t id = 0; id < consumers; ++id) {
+    Check(buffer.Available(id) == 0, "consumer drained");
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint64_t ops = 1'000'000;
+  for (int ind = 1; ind + 1 < argc; ind += 2) {
+    if (std::strcmp(argv[ind], "--ops") == 0) {
+      ops = std::strtoull(argv[ind + 1], nullptr, 10);
+    }
+  }
+  TestSlowestConsumerGates();
+  TestSpansAcrossWrap();
+  for (size_t capacity : {1, 5, 64}) {
+    TestConcurrentConsumers(capacity, 3, ops / 10);
+  }
+  std::cout << "ok\n";
+  return 0;
+}
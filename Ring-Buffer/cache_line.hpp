@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+
+// Размер кэш-линии: счётчики, которые пишут разные потоки, разносятся по
+// разным линиям, чтобы потоки не делили одну линию (false sharing).
+inline constexpr size_t kCacheLineSize = 64;
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "cache_line.hpp"
+#include "ring_buffer.hpp"
+
+// Кольцевой буфер одного производителя и одного потребителя, у которого
+// ячейки и индексы begin/end лежат в отображённом в память файле (или в
+// сегменте /dev/shm). Перезапущенный процесс или второй процесс открывает
+// тот же файл и продолжает с места остановки без сериализации.
+//
+// Упавший посреди записи производитель теряет только неопубликованный
+// элемент; упавший потребитель может получить последний элемент повторно.
+// Файл, создание которого прервалось до записи заголовка (нулевой
+// заголовок), инициализируется заново. Flush() нужен только для
+// переживания отказа питания.
+template <typename T>
+class MappedRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "elements are stored in the file byte by byte");
+
+ public:
+  static constexpr uint64_t kMagic = 0x4D52'494E'4742'5546;  // "MRINGBUF"
+  static constexpr uint32_t kFormatVersion = 1;
+
+  // Создаёт файл path или подключается к существующему. Ёмкость
+  // округляется вверх до степени двойки и должна совпадать с записанной в
+  // заголовке.
+  MappedRingBuffer(const std::string& path, size_t capacity)
+      : slots_(RoundUpToPowerOfTwo(capacity)) {
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd_ < 0) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    try {
+      attach(path);
+    } catch (...) {
+      close(fd_);
+      throw;
+    }
+  }
+
+  MappedRingBuffer(const MappedRingBuffer&) = delete;
+  MappedRingBuffer& operator=(const MappedRingBuffer&) = delete;
+
+  ~MappedRingBuffer() {
+    munmap(map_, map_size_);
+    close(fd_);
+  }
+
+  size_t Size() const {
+    uint64_t begin = header_->begin.load(std::memory_order_acquire);
+    uint64_t end = header_->end.load(std::memory_order_acquire);
+    return (end > begin) ? end - begin : 0;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  size_t Capacity() const { return slots_; }
+
+  bool TryPush(const T& element) {
+    uint64_t end = header_->end.load(std::memory_order_relaxed);
+    if (end - cached_begin_ == slots_) {
+      cached_begin_ = header_->begin.load(std::memory_order_acquire);
+      if (end - cached_begin_ == slots_) {
+        return false;
+      }
+    }
+    std::memcpy(slot(end), &element, sizeof(T));
+    header_->end.store(end + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T* element) {
+    uint64_t begin = header_->begin.load(std::memory_order_relaxed);
+    if (begin == cached_end_) {
+      cached_end_ = header_->end.load(std::memory_order_acquire);
+      if (begin == cached_end_) {
+        return false;
+      }
+    }
+    std::memcpy(element, slot(begin), sizeof(T));
+    header_->begin.store(begin + 1, std::memory_order_release);
+    return true;
+  }
+
+  void Flush() {
+    if (msync(map_, map_size_, MS_SYNC) != 0) {
+      throw std::system_error(errno, std::generic_category(), "msync");
+    }
+  }
+
+ private:
+  // Заголовок в начале файла; ячейки начинаются со следующей страницы.
+  struct Header {
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t element_size;
+    uint64_t capacity;
+    alignas(kCacheLineSize) std::atomic<uint64_t> begin;
+    alignas(kCacheLineSize) std::atomic<uint64_t> end;
+  };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "indices must be atomic across processes");
+
+  size_t slots_;
+  int fd_ = -1;
+  void* map_ = nullptr;
+  size_t map_size_ = 0;
+  size_t data_offset_ = 0;
+  Header* header_ = nullptr;
+  uint64_t cached_begin_ = 0;  // копии индексов другой стороны
+  uint64_t cached_end_ = 0;
+
+  unsigned char* slot(uint64_t index) {
+    return static_cast<unsigned char*>(map_) + data_offset_ +
+           (index & (slots_ - 1)) * sizeof(T);
+  }
+
+  // flock на время жизни объекта; снимается и при исключении.
+  class FileLock {
+   public:
+    FileLock(int fd, const std::string& path) : fd_(fd) {
+      int res;
+      do {
+        res = flock(fd_, LOCK_EX);
+      } while (res != 0 && errno == EINTR);
+      if (res != 0) {
+        throw std::system_error(errno, std::generic_category(), path);
+      }
+    }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    ~FileLock() { flock(fd_, LOCK_UN); }
+
+   private:
+    int fd_;
+  };
+
+  // Заголовок из одних нулей: файл создан (ftruncate), но процесс упал
+  // раньше, чем записал magic.
+  bool header_is_zero() const {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(header_);
+    for (size_t ind = 0; ind < sizeof(Header); ++ind) {
+      if (bytes[ind] != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void attach(const std::string& path) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    data_offset_ = (sizeof(Header) + page - 1) / page * page;
+    map_size_ = data_offset_ + slots_ * sizeof(T);
+
+    // Инициализацию и проверку заголовка делает один процесс за раз.
+    FileLock lock(fd_, path);
+    struct stat info;
+    if (fstat(fd_, &info) != 0) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    if (info.st_size == 0 && ftruncate(fd_, map_size_) != 0) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    if (info.st_size != 0 && static_cast<size_t>(info.st_size) != map_size_) {
+      throw std::runtime_error(path + ": file size does not match capacity");
+    }
+    map_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map_ == MAP_FAILED) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    header_ = static_cast<Header*>(map_);
+    if (header_is_zero()) {
+      header_->version = kFormatVersion;
+      header_->element_size = sizeof(T);
+      header_->capacity = slots_;
+      header_->begin.store(0, std::memory_order_relaxed);
+      header_->end.store(0, std::memory_order_relaxed);
+      header_->magic.store(kMagic, std::memory_order_release);
+    }
+    if (header_->magic.load(std::memory_order_acquire) != kMagic ||
+        header_->version != kFormatVersion ||
+        header_->element_size != sizeof(T) || header_->capacity != slots_) {
+      munmap(map_, map_size_);
+      throw std::runtime_error(path + ": incompatible ring buffer header");
+    }
+    cached_begin_ = header_->begin.load(std::memory_order_acquire);
+    cached_end_ = header_->end.load(std::memory_order_acquire);
+  }
+};
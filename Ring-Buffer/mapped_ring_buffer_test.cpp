@@ -0,0 +1,150 @@
+// Проверки MappedRingBuffer: восстановление после убитого посреди потока
+// производителя, файл с недописанным (нулевым) заголовком и несовпадающие
+// параметры.
+//
+//   mapped_ring_buffer_test
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "mapped_ring_buffer.hpp"
+
+namespace {
+
+constexpr size_t kCapacity = 1024;
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::cerr << what << " failed\n";
+    std::exit(1);
+  }
+}
+
+std::string TempPath(const char* name) {
+  return (std::filesystem::temp_directory_path() /
+          (std::string(name) + "." + std::to_string(getpid())))
+      .string();
+}
+
+// Дочерний процесс пишет 0, 1, 2, ... без остановки; родитель читает,
+// убивает его SIGKILL посреди потока и дочитывает остаток. Затем новый
+// производитель продолжает последовательность в том же файле.
+void TestKilledWriter() {
+  std::string path = TempPath("mapped_ring_buffer_test_kill");
+  std::filesystem::remove(path);
+  pid_t child = fork();
+  Check(child >= 0, "fork");
+  if (child == 0) {
+    MappedRingBuffer<uint64_t> buffer(path, kCapacity);
+    for (uint64_t value = 0;;) {
+      if (buffer.TryPush(value)) {
+        ++value;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  // Ждём, пока производитель создаст файл.
+  while (true) {
+    std::error_code error;
+    if (std::filesystem::file_size(path, error) > 0 && !error) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  uint64_t expected = 0;
+  {
+    MappedRingBuffer<uint64_t> buffer(path, kCapacity);
+    uint64_t value;
+    while (expected < 100 * kCapacity) {
+      if (buffer.TryPop(&value)) {
+        Check(value == expected, "order before kill");
+        ++expected;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    Check(kill(child, SIGKILL) == 0, "kill");
+    int status;
+    Check(waitpid(child, &status, 0) == child, "waitpid");
+    Check(WIFSIGNALED(status), "writer killed");
+    while (buffer.TryPop(&value)) {
+      Check(value == expected, "order after kill");
+      ++expected;
+    }
+  }
+
+  // Перезапуск: читатель и писатель открывают файл заново.
+  MappedRingBuffer<uint64_t> reader(path, kCapacity);
+  MappedRingBuffer<uint64_t> writer(path, kCapacity);
+  Check(reader.Empty(), "drained after restart");
+  for (uint64_t ind = 0; ind < 3 * kCapacity; ++ind) {
+    Check(writer.TryPush(expected + ind), "push after restart");
+    uint64_t value;
+    Check(reader.TryPop(&value) && value == expected + ind,
+          "pop after restart");
+  }
+  std::filesystem::remove(path);
+}
+
+// Файл нужного размера из нулей - создатель упал между ftruncate и записью
+// заголовка. Такой файл должен подхватываться, а не отвергаться навсегда.
+void TestZeroHeader() {
+  std::string path = TempPath("mapped_ring_buffer_test_zero");
+  {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    Check(fd >= 0, "create zero file");
+    size_t map_size = sysconf(_SC_PAGESIZE) + kCapacity * sizeof(uint64_t);
+    Check(ftruncate(fd, map_size) == 0, "ftruncate zero file");
+    close(fd);
+  }
+  MappedRingBuffer<uint64_t> buffer(path, kCapacity);
+  Check(buffer.Empty(), "zero header: empty");
+  Check(buffer.TryPush(7), "zero header: push");
+  uint64_t value;
+  Check(buffer.TryPop(&value) && value == 7, "zero header: pop");
+  std::filesystem::remove(path);
+}
+
+void TestMismatch() {
+  std::string path = TempPath("mapped_ring_buffer_test_mismatch");
+  std::filesystem::remove(path);
+  { MappedRingBuffer<uint64_t> buffer(path, kCapacity); }
+  bool thrown = false;
+  try {
+    MappedRingBuffer<uint64_t> buffer(path, 2 * kCapacity);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  Check(thrown, "capacity mismatch");
+  thrown = false;
+  try {
+    MappedRingBuffer<uint32_t> buffer(path, 2 * kCapacity);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  Check(thrown, "element size mismatch");
+  std::filesystem::remove(path);
+}
+
+}  // namespace
+
+int main() {
+  TestKilledWriter();
+  TestZeroHeader();
+  TestMismatch();
+  std::cout << "ok\n";
+  return 0;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "cache_line.hpp"
+#include "ring_buffer.hpp"
+
+// Ограниченная очередь для нескольких производителей и потребителей (схема
+// Вьюкова). У каждой ячейки свой номер sequence: ячейка с индексом pos
+// свободна для записи, когда sequence == pos, и готова к чтению, когда
+// sequence == pos + 1. Ёмкость округляется вверх до степени двойки, но не
+// меньше двух: при одной ячейке номер «готова к чтению» совпадает с номером
+// «свободна» следующего круга.
+template <typename T = int, size_t kCapacity = kDynamicCapacity>
+class MpmcRingBuffer {
+  static_assert(kCapacity == kDynamicCapacity || kCapacity >= 2,
+                "MpmcRingBuffer needs at least two cells");
+
+ public:
+  MpmcRingBuffer()
+    requires(kCapacity != kDynamicCapacity)
+  {
+    init_cells();
+  }
+
+  explicit MpmcRingBuffer(size_t capacity)
+    requires(kCapacity == kDynamicCapacity)
+      : storage_(RoundUpToPowerOfTwo(std::max<size_t>(2, capacity))) {
+    init_cells();
+  }
+
+  MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+  MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+  // Приблизительный размер: точен, только пока очередь никто не меняет.
+  size_t Size() const {
+    size_t begin = begin_.load(std::memory_order_acquire);
+    size_t end = end_.load(std::memory_order_acquire);
+    return (end > begin) ? end - begin : 0;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  size_t Capacity() const { return storage_.Capacity(); }
+
+  bool TryPush(const T& element) { return TryEmplace(element); }
+
+  bool TryPush(T&& element) { return TryEmplace(std::move(element)); }
+
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    size_t pos = end_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = storage_.Slot(pos);
+      auto diff = static_cast<ptrdiff_t>(
+          cell->sequence.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (end_.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = end_.load(std::memory_order_relaxed);
+      }
+    }
+    std::construct_at(cell->Value(), std::forward<Args>(args)...);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T* element) {
+    size_t pos = begin_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = storage_.Slot(pos);
+      auto diff = static_cast<ptrdiff_t>(
+          cell->sequence.load(std::memory_order_acquire) - (pos + 1));
+      if (diff == 0) {
+        if (begin_.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = begin_.load(std::memory_order_relaxed);
+      }
+    }
+    *element = std::move(*cell->Value());
+    std::destroy_at(cell->Value());
+    cell->sequence.store(pos + storage_.Capacity(), std::memory_order_release);
+    return true;
+  }
+
+  ~MpmcRingBuffer() {
+    size_t end = end_.load(std::memory_order_acquire);
+    for (size_t pos = begin_.load(std::memory_order_relaxed); pos != end;
+         ++pos) {
+      std::destroy_at(storage_.Slot(pos)->Value());
+    }
+    for (size_t ind = 0; ind < storage_.Capacity(); ++ind) {
+      std::destroy_at(storage_.Slot(ind));
+    }
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    alignas(T) unsigned char bytes[sizeof(T)];
+
+    explicit Cell(size_t seq) : sequence(seq) {}
+
+    T* Value() { return std::launder(reinterpret_cast<T*>(bytes)); }
+  };
+
+  RingStorage<Cell, kCapacity> storage_;
+
+  alignas(kCacheLineSize) std::atomic<size_t> begin_ = 0;  // потребители
+  alignas(kCacheLineSize) std::atomic<size_t> end_ = 0;    // производители
+
+  void init_cells() {
+    for (size_t ind = 0; ind < storage_.Capacity(); ++ind) {
+      std::construct_at(storage_.Slot(ind), ind);
+    }
+  }
+};
@@ -0,0 +1,109 @@
+// Проверки MpmcRingBuffer: ёмкость не меньше двух ячеек и сохранность
+// элементов при нескольких производителях и потребителях.
+//
+//   mpmc_ring_buffer_test
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpmc_ring_buffer.hpp"
+
+namespace {
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::cerr << what << " failed\n";
+    std::exit(1);
+  }
+}
+
+// Очередь заполняется до отказа и опустошается: лишний TryPush не должен
+// затирать непрочитанный элемент, а TryPop из пустой очереди - зависать.
+template <typename Buffer>
+void CheckFillAndDrain(Buffer& buffer, const char* what) {
+  Check(buffer.Capacity() >= 2, what);
+  for (size_t ind = 0; ind < buffer.Capacity(); ++ind) {
+    Check(buffer.TryPush(std::to_string(ind)), what);
+  }
+  Check(!buffer.TryPush("extra"), what);
+  Check(buffer.Size() == buffer.Capacity(), what);
+  std::string value;
+  for (size_t ind = 0; ind < buffer.Capacity(); ++ind) {
+    Check(buffer.TryPop(&value) && value == std::to_string(ind), what);
+  }
+  Check(!buffer.TryPop(&value), what);
+  Check(buffer.Empty(), what);
+}
+
+void TestSmallCapacity() {
+  for (size_t capacity : {0, 1, 2, 3}) {
+    MpmcRingBuffer<std::string> buffer(capacity);
+    CheckFillAndDrain(buffer, "dynamic small capacity");
+    CheckFillAndDrain(buffer, "dynamic small capacity, second lap");
+  }
+  MpmcRingBuffer<std::string, 2> fixed;
+  CheckFillAndDrain(fixed, "fixed capacity 2");
+  CheckFillAndDrain(fixed, "fixed capacity 2, second lap");
+}
+
+// producers потоков кладут свои числа, consumers потоков забирают; сумма и
+// число забранных должны сойтись.
+void TestThreads(size_t capacity, size_t producers, size_t consumers) {
+  const uint64_t per_producer = 100'000;
+  MpmcRingBuffer<uint64_t> buffer(capacity);
+  std::vector<uint64_t> sums(consumers, 0);
+  std::vector<uint64_t> counts(consumers, 0);
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < producers; ++id) {
+    threads.emplace_back([&buffer, id, per_producer] {
+      for (uint64_t ind = 0; ind < per_producer; ++ind) {
+        while (!buffer.TryPush(id * per_producer + ind)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  const uint64_t total = producers * per_producer;
+  std::atomic<uint64_t> taken = 0;
+  for (size_t id = 0; id < consumers; ++id) {
+    threads.emplace_back([&, id] {
+      uint64_t value;
+      while (taken.load(std::memory_order_relaxed) < total) {
+        if (buffer.TryPop(&value)) {
+          sums[id] += value;
+          ++counts[id];
+          taken.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  uint64_t sum = 0;
+  uint64_t count = 0;
+  for (size_t id = 0; id < consumers; ++id) {
+    sum += sums[id];
+    count += counts[id];
+  }
+  Check(count == total, "threads: count");
+  Check(sum == total * (total - 1) / 2, "threads: sum");
+  Check(buffer.Empty(), "threads: empty");
+}
+
+}  // namespace
+
+int main() {
+  TestSmallCapacity();
+  TestThreads(1, 2, 2);
+  TestThreads(64, 4, 4);
+  std::cout << "ok\n";
+  return 0;
+}
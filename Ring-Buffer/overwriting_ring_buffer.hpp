@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "cache_line.hpp"
+#include "ring_buffer.hpp"
+
+// Буфер-самописец: хранит последние Capacity() значений, новое значение
+// затирает самое старое, и Push никогда не ждёт. Писатель один, читателей
+// сколько угодно; читатели не мешают писателю, а проверяют целостность
+// каждой ячейки по её номеру версии (seqlock). Ёмкость округляется вверх до
+// степени двойки.
+template <typename T, size_t kCapacity = kDynamicCapacity>
+class OverwritingRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "readers copy slots while the writer may overwrite them");
+
+ public:
+  OverwritingRingBuffer()
+    requires(kCapacity != kDynamicCapacity)
+  {
+    init_cells();
+  }
+
+  explicit OverwritingRingBuffer(size_t capacity)
+    requires(kCapacity == kDynamicCapacity)
+      : storage_(RoundUpToPowerOfTwo(capacity)) {
+    init_cells();
+  }
+
+  OverwritingRingBuffer(const OverwritingRingBuffer&) = delete;
+  OverwritingRingBuffer& operator=(const OverwritingRingBuffer&) = delete;
+
+  ~OverwritingRingBuffer() {
+    for (size_t ind = 0; ind < storage_.Capacity(); ++ind) {
+      std::destroy_at(storage_.Slot(ind));
+    }
+  }
+
+  size_t Capacity() const { return storage_.Capacity(); }
+
+  size_t Size() const {
+    return std::min<size_t>(end_.load(std::memory_order_acquire),
+                            storage_.Capacity());
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  // Сколько значений было затёрто новыми.
+  size_t Dropped() const {
+    size_t end = end_.load(std::memory_order_acquire);
+    return (end > storage_.Capacity()) ? end - storage_.Capacity() : 0;
+  }
+
+  // Вызывается только писателем.
+  void Push(const T& value) {
+    size_t pos = end_.load(std::memory_order_relaxed);
+    Cell* cell = storage_.Slot(pos);
+    cell->version.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(cell->bytes, &value, sizeof(T));
+    cell->version.store(2 * pos + 2, std::memory_order_release);
+    end_.store(pos + 1, std::memory_order_release);
+  }
+
+  // Копия последних значений от старых к новым. Значения, затёртые
+  // писателем во время копирования, отбрасываются вместе со всеми более
+  // старыми, так что результат - непрерывный хвост потока без порванных
+  // значений.
+  std::vector<T> Snapshot() const {
+    size_t end = end_.load(std::memory_order_acquire);
+    size_t pos = (end > storage_.Capacity()) ? end - storage_.Capacity() : 0;
+    std::vector<T> result;
+    result.reserve(end - pos);
+    T value;
+    for (; pos < end; ++pos) {
+      if (read_cell(pos, &value)) {
+        result.push_back(value);
+      } else {
+        result.clear();
+      }
+    }
+    return result;
+  }
+
+ private:
+  // version: 0 - ячейка пуста, 2 * pos + 1 - идёт запись значения с
+  // номером pos, 2 * pos + 2 - значение pos записано.
+  struct Cell {
+    std::atomic<uint64_t> version = 0;
+    alignas(T) unsigned char bytes[sizeof(T)];
+  };
+
+  RingStorage<Cell, kCapacity> storage_;
+  alignas(kCacheLineSize) std::atomic<size_t> end_ = 0;
+
+  void init_cells() {
+    for (size_t ind = 0; ind < storage_.Capacity(); ++ind) {
+      std::construct_at(storage_.Slot(ind));
+    }
+  }
+
+  bool read_cell(size_t pos, T* value) const {
+    const Cell* cell = storage_.Slot(pos);
+    uint64_t version = cell->version.load(std::memory_order_acquire);
+    if (version != 2 * pos + 2) {
+      return false;
+    }
+    std::memcpy(value, cell->bytes, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return cell->version.load(std::memory_order_relaxed) == version;
+  }
+};
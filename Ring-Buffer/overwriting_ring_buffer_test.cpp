@@ -0,0 +1,146 @@
+// Проверки OverwritingRingBuffer: Snapshot() и Dropped() после переполнения
+// и непрерывность снимков, которые снимаются одновременно с записью.
+//
+//   overwriting_ring_buffer_test [--ops N]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "overwriting_ring_buffer.hpp"
+
+namespace {
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::cerr << what << " failed\n";
+    std::exit(1);
+  }
+}
+
+// Запись из нескольких слов, выведенных из номера: порванная копия, в
+// которой слова от разных записей, не пройдёт Valid().
+struct Record {
+  uint64_t seq;
+  uint64_t words[7];
+
+  static Record Make(uint64_t seq) {
+    Record record{seq, {}};
+    for (uint64_t ind = 0; ind < 7; ++ind) {
+      record.words[ind] = seq * 0x9E3779B97F4A7C15ULL + ind;
+    }
+    return record;
+  }
+
+  bool Valid() const {
+    for (uint64_t ind = 0; ind < 7; ++ind) {
+      if (words[ind] != seq * 0x9E3779B97F4A7C15ULL + ind) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+void TestSnapshotAfterWrap() {
+  OverwritingRingBuffer<uint64_t> buffer(5);
+  Check(buffer.Capacity() == 8, "capacity rounded up");
+  Check(buffer.Snapshot().empty() && buffer.Dropped() == 0, "empty buffer");
+
+  for (uint64_t ind = 0; ind < 3; ++ind) {
+    buffer.Push(ind);
+  }
+  Check(buffer.Snapshot() == std::vector<uint64_t>({0, 1, 2}),
+        "snapshot before wrap");
+  Check(buffer.Size() == 3 && buffer.Dropped() == 0, "size before wrap");
+
+  for (uint64_t ind = 3; ind < 20; ++ind) {
+    buffer.Push(ind);
+  }
+  std::vector<uint64_t> expected;
+  for (uint64_t ind = 12; ind < 20; ++ind) {
+    expected.push_back(ind);
+  }
+  Check(buffer.Snapshot() == expected, "snapshot after wrap");
+  Check(buffer.Size() == 8 && buffer.Dropped() == 12, "dropped after wrap");
+
+  OverwritingRingBuffer<uint64_t, 4> fixed;
+  for (uint64_t ind = 0; ind < 6; ++ind) {
+    fixed.Push(ind);
+  }
+  Check(fixed.Snapshot() == std::vector<uint64_t>({2, 3, 4, 5}),
+        "fixed capacity snapshot");
+}
+
+// Писатель не останавливается, читатели снимают снимки. Писатель обгоняет
+// читателя, поэтому начало снимка может быть отброшено, но каждый снимок -
+// непрерывный хвост из целых записей: номера идут подряд, последний из них
+// уже записан, а отброшенных не меньше, чем Dropped() до снимка. Писатель
+// не останавливается, пока читатели не снимут хотя бы kMinSnapshots
+// снимков, чтобы снимки действительно шли вперемешку с записью.
+void TestConcurrentSnapshots(size_t capacity, uint64_t ops) {
+  constexpr uint64_t kMinSnapshots = 1000;
+  OverwritingRingBuffer<Record> buffer(capacity);
+  std::atomic<bool> done = false;
+  std::atomic<uint64_t> snapshots = 0;
+  uint64_t written = 0;
+  std::thread writer([&] {
+    while (written < ops ||
+           snapshots.load(std::memory_order_relaxed) < kMinSnapshots) {
+      buffer.Push(Record::Make(written++));
+    }
+    done.store(true, std::memory_order_release);
+  });
+
+  auto reader = [&buffer, &done, &snapshots, capacity] {
+    while (!done.load(std::memory_order_acquire)) {
+      size_t dropped = buffer.Dropped();
+      std::vector<Record> snapshot = buffer.Snapshot();
+      size_t pushed = buffer.Dropped() + buffer.Size();
+      snapshots.fetch_add(1, std::memory_order_relaxed);
+      Check(snapshot.size() <= capacity, "snapshot size");
+      for (size_t ind = 0; ind < snapshot.size(); ++ind) {
+        Check(snapshot[ind].Valid(), "snapshot record intact");
+        Check(ind == 0 || snapshot[ind].seq == snapshot[ind - 1].seq + 1,
+              "snapshot contiguous");
+      }
+      if (!snapshot.empty()) {
+        Check(snapshot.front().seq >= dropped, "snapshot skips dropped");
+        Check(snapshot.back().seq < pushed, "snapshot only written values");
+      }
+    }
+  };
+  std::thread first(reader);
+  std::thread second(reader);
+  writer.join();
+  first.join();
+  second.join();
+
+  std::vector<Record> snapshot = buffer.Snapshot();
+  Check(snapshot.size() == std::min<uint64_t>(capacity, written),
+        "final snapshot size");
+  Check(snapshot.back().seq == written - 1, "final snapshot tail");
+  Check(buffer.Dropped() == written - snapshot.size(), "final dropped");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint64_t ops = 1'000'000;
+  for (int ind = 1; ind + 1 < argc; ind += 2) {
+    if (std::strcmp(argv[ind], "--ops") == 0) {
+      ops = std::strtoull(argv[ind + 1], nullptr, 10);
+    }
+  }
+  TestSnapshotAfterWrap();
+  for (size_t capacity : {2, 16, 1024}) {
+    TestConcurrentSnapshots(capacity, ops);
+  }
+  std::cout << "ok\n";
+  return 0;
+}
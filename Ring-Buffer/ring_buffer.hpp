@@ -1,43 +1,277 @@
 #pragma once
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+// Ёмкость задаётся в конструкторе, а не параметром шаблона.
+inline constexpr size_t kDynamicCapacity = 0;
+
+// kMirrored: одни и те же физические страницы отображаются дважды подряд,
+// так что любой кусок кольца непрерывен в адресах. Доступно для тривиально
+// копируемых T на Linux; если отобразить не удалось, используется kHeap.
+enum class RingBacking { kHeap, kMirrored };
+
+constexpr size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+// Сырая выровненная память под элементы кольца. Число ячеек - степень двойки,
+// поэтому позиция считается маской, а не делением. Объекты в ячейках создаёт
+// и уничтожает владелец.
+template <typename T, size_t kCapacity>
+class RingStorage {
+ public:
+  static constexpr size_t kSlots = RoundUpToPowerOfTwo(kCapacity);
+
+  size_t Capacity() const { return kSlots; }
+
+  size_t Slots() const { return kSlots; }
+
+  T* Slot(size_t index) {
+    return std::launder(reinterpret_cast<T*>(bytes_)) + (index & (kSlots - 1));
+  }
+
+  const T* Slot(size_t index) const {
+    return std::launder(reinterpret_cast<const T*>(bytes_)) +
+           (index & (kSlots - 1));
+  }
+
+ private:
+  alignas(T) unsigned char bytes_[kSlots * sizeof(T)];
+};
+
+template <typename T>
+class RingStorage<T, kDynamicCapacity> {
+ public:
+  explicit RingStorage(size_t capacity,
+                       RingBacking backing = RingBacking::kHeap)
+      : size_max_(capacity), mask_(RoundUpToPowerOfTwo(capacity) - 1) {
+    if (backing == RingBacking::kMirrored && map_mirrored()) {
+      return;
+    }
+    arr_ = alloc_.allocate(mask_ + 1);
+  }
+
+  RingStorage(const RingStorage&) = delete;
+  RingStorage& operator=(const RingStorage&) = delete;
+
+  ~RingStorage() {
+#if defined(__linux__)
+    if (mirrored_) {
+      munmap(arr_, 2 * (mask_ + 1) * sizeof(T));
+      return;
+    }
+#endif
+    alloc_.deallocate(arr_, mask_ + 1);
+  }
+
+  size_t Capacity() const { return size_max_; }
+
+  size_t Slots() const { return mask_ + 1; }
+
+  // Если true, за Slot(Slots() - 1) в памяти снова идёт Slot(0).
+  bool Mirrored() const { return mirrored_; }
+
+  T* Slot(size_t index) { return arr_ + (index & mask_); }
+
+  const T* Slot(size_t index) const { return arr_ + (index & mask_); }
+
+ private:
+  size_t size_max_;
+  size_t mask_;
+  std::allocator<T> alloc_;
+  T* arr_;
+  bool mirrored_ = false;
 
+  bool map_mirrored() {
+#if defined(__linux__)
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      // Размер отображения кратен странице, число ячеек - степень двойки.
+      size_t page = sysconf(_SC_PAGESIZE);
+      size_t slots = std::max(mask_ + 1, page / std::gcd(sizeof(T), page));
+      size_t bytes = slots * sizeof(T);
+      int fd = memfd_create("ring_buffer", MFD_CLOEXEC);
+      if (fd < 0) {
+        return false;
+      }
+      void* base = MAP_FAILED;
+      if (ftruncate(fd, bytes) == 0) {
+        base = mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS,
+                    -1, 0);
+      }
+      if (base != MAP_FAILED) {
+        auto* half = static_cast<unsigned char*>(base);
+        if (mmap(half, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                 fd, 0) == MAP_FAILED ||
+            mmap(half + bytes, bytes, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+          munmap(base, 2 * bytes);
+          base = MAP_FAILED;
+        }
+      }
+      close(fd);
+      if (base == MAP_FAILED) {
+        return false;
+      }
+      arr_ = static_cast<T*>(base);
+      mask_ = slots - 1;
+      mirrored_ = true;
+      return true;
+    }
+#endif
+    return false;
+  }
+};
+
+// Кольцевой буфер на T. С kCapacity != kDynamicCapacity ёмкость округляется
+// вверх до степени двойки и память лежит внутри объекта. RingBuffer без
+// аргументов шаблона - прежний буфер int с ёмкостью из конструктора.
+template <typename T = int, size_t kCapacity = kDynamicCapacity>
 class RingBuffer {
  public:
-  explicit RingBuffer(size_t capacity) : size_max_(capacity) {
-    arr_ = new int[size_max_];
+  RingBuffer()
+    requires(kCapacity != kDynamicCapacity)
+  = default;
+
+  explicit RingBuffer(size_t capacity, RingBacking backing = RingBacking::kHeap)
+    requires(kCapacity == kDynamicCapacity)
+      : storage_(capacity, backing) {}
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  size_t Size() const { return end_ - begin_; }
+
+  bool Empty() const { return begin_ == end_; }
+
+  size_t Capacity() const { return storage_.Capacity(); }
+
+  bool Mirrored() const {
+    if constexpr (kCapacity == kDynamicCapacity) {
+      return storage_.Mirrored();
+    }
+    return false;
   }
 
-  size_t Size() const { return size_now_; }
+  bool TryPush(const T& element) { return TryEmplace(element); }
 
-  bool Empty() const { return (size_now_ == 0); }
+  bool TryPush(T&& element) { return TryEmplace(std::move(element)); }
 
-  bool TryPush(int element) {
-    if (size_now_ == size_max_) {
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    if (Size() == storage_.Capacity()) {
       return false;
     }
-    arr_[end_] = element;
-    end_ = (end_ + 1) % size_max_;
-    ++size_now_;
+    std::construct_at(storage_.Slot(end_), std::forward<Args>(args)...);
+    ++end_;
     return true;
   }
 
-  bool TryPop(int* element) {
-    if (size_now_ == 0) {
+  bool TryPop(T* element) {
+    if (Empty()) {
       return false;
     }
-    *element = arr_[begin_];
-    begin_ = (begin_ + 1) % size_max_;
-    --size_now_;
+    T* slot = storage_.Slot(begin_);
+    *element = std::move(*slot);
+    std::destroy_at(slot);
+    ++begin_;
     return true;
   }
 
-  ~RingBuffer() { delete[] arr_; }
+  // Кладёт элементы [first, last), пока есть место; возвращает их число.
+  template <std::forward_iterator Iter>
+  size_t TryPushBulk(Iter first, Iter last) {
+    size_t count = std::min<size_t>(std::distance(first, last),
+                                    storage_.Capacity() - Size());
+    for (std::span<T> span : split_range(end_, count)) {
+      std::uninitialized_copy_n(first, span.size(), span.data());
+      std::advance(first, span.size());
+      end_ += span.size();
+    }
+    return count;
+  }
+
+  // Переносит в out не больше max элементов; возвращает их число.
+  template <typename OutputIter>
+  size_t TryPopBulk(OutputIter out, size_t max) {
+    size_t count = std::min(max, Size());
+    for (std::span<T> span : split_range(begin_, count)) {
+      out = std::move(span.begin(), span.end(), out);
+      std::destroy(span.begin(), span.end());
+      begin_ += span.size();
+    }
+    return count;
+  }
+
+  // Занятые ячейки одним или двумя непрерывными кусками, от старых к новым
+  // (при Mirrored() - всегда одним).
+  // После обработки куски освобождаются одним вызовом CommitRead.
+  std::pair<std::span<T>, std::span<T>> ReadableSpans() {
+    auto spans = split_range(begin_, Size());
+    return {spans[0], spans[1]};
+  }
+
+  void CommitRead(size_t count) {
+    for (std::span<T> span : split_range(begin_, count)) {
+      std::destroy(span.begin(), span.end());
+    }
+    begin_ += count;
+  }
+
+  // Свободные ячейки одним или двумя кусками. Память в них не
+  // инициализирована, поэтому запись напрямую (memcpy) доступна только для
+  // тривиально копируемых T; CommitWrite делает записанное видимым.
+  std::pair<std::span<T>, std::span<T>> WritableSpans()
+    requires std::is_trivially_copyable_v<T>
+  {
+    auto spans = split_range(end_, storage_.Capacity() - Size());
+    return {spans[0], spans[1]};
+  }
+
+  void CommitWrite(size_t count)
+    requires std::is_trivially_copyable_v<T>
+  {
+    end_ += count;
+  }
+
+  ~RingBuffer() {
+    for (; begin_ != end_; ++begin_) {
+      std::destroy_at(storage_.Slot(begin_));
+    }
+  }
 
  private:
-  size_t size_max_;
-  size_t size_now_ = 0;
+  // begin_ и end_ растут монотонно, ячейка - storage_.Slot(индекс).
+  RingStorage<T, kCapacity> storage_;
   size_t begin_ = 0;
   size_t end_ = 0;
-  int* arr_;
+
+  // count ячеек начиная с индекса start, разбитые на куски по краю массива.
+  std::array<std::span<T>, 2> split_range(size_t start, size_t count) {
+    T* first = storage_.Slot(start);
+    if (Mirrored()) {
+      return {std::span<T>(first, count), std::span<T>()};
+    }
+    size_t head = std::min(count, static_cast<size_t>(storage_.Slot(0) +
+                                                      storage_.Slots() - first));
+    return {std::span<T>(first, head),
+            std::span<T>(storage_.Slot(0), count - head)};
+  }
 };
@@ -0,0 +1,163 @@
+// Пропускная способность и задержка push -> pop для кольцевых буферов.
+//
+//   ring_buffer_benchmark [--ops N] [--max-threads N] [--out file.json]
+//
+// Результат - JSON, чтобы сравнивать прогоны между версиями.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Benchmark/benchmark.hpp"
+#include "mpmc_ring_buffer.hpp"
+#include "ring_buffer.hpp"
+#include "spsc_ring_buffer.hpp"
+
+namespace {
+
+// threads - сколько потоков работало: в однопоточном прогоне один поток
+// и кладёт, и забирает.
+BenchmarkRow MakeResult(const std::string& name, size_t threads,
+                        size_t producers, size_t consumers, size_t capacity,
+                        uint64_t ops, uint64_t elapsed_ns,
+                        std::vector<uint64_t> latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  auto ops_per_sec = static_cast<uint64_t>(
+      ops * 1e9 / std::max<uint64_t>(elapsed_ns, 1));
+  return BenchmarkRow()
+      .Add("name", name)
+      .Add("threads", threads)
+      .Add("producers", producers)
+      .Add("consumers", consumers)
+      .Add("capacity", capacity)
+      .Add("ops", ops)
+      .Add("ops_per_sec", ops_per_sec)
+      .Add("latency_ns", BenchmarkRow()
+                             .Add("p50", Percentile(latencies, 0.5))
+                             .Add("p99", Percentile(latencies, 0.99))
+                             .Add("p999", Percentile(latencies, 0.999)));
+}
+
+// Один поток: элементы проходят через буфер пачками по половине ёмкости,
+// задержка - время от TryPush до TryPop одного и того же элемента.
+template <typename Buffer>
+BenchmarkRow RunSingleThreaded(const std::string& name, Buffer& buffer,
+                               size_t capacity, uint64_t ops) {
+  std::vector<uint64_t> latencies;
+  latencies.reserve(ops);
+  size_t batch = std::max<size_t>(capacity / 2, 1);
+  uint64_t start = NowNs();
+  for (uint64_t done = 0; done < ops;) {
+    size_t count = std::min<uint64_t>(batch, ops - done);
+    for (size_t ind = 0; ind < count; ++ind) {
+      buffer.TryPush(NowNs());
+    }
+    uint64_t stamp;
+    while (buffer.TryPop(&stamp)) {
+      latencies.push_back(NowNs() - stamp);
+    }
+    done += count;
+  }
+  uint64_t elapsed = NowNs() - start;
+  return MakeResult(name, 1, 1, 1, capacity, ops, elapsed,
+                    std::move(latencies));
+}
+
+// producers потоков кладут отметки времени, consumers потоков их забирают.
+template <typename Buffer>
+BenchmarkRow RunThreaded(const std::string& name, Buffer& buffer,
+                         size_t producers, size_t consumers, size_t capacity,
+                         uint64_t ops) {
+  std::atomic<uint64_t> consumed = 0;
+  std::atomic<bool> go = false;
+  std::vector<std::vector<uint64_t>> latencies(consumers);
+  std::vector<std::thread> threads;
+
+  for (size_t id = 0; id < producers; ++id) {
+    uint64_t share = ops / producers + (id < ops % producers ? 1 : 0);
+    threads.emplace_back([&, share] {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (uint64_t ind = 0; ind < share;) {
+        if (buffer.TryPush(NowNs())) {
+          ++ind;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (size_t id = 0; id < consumers; ++id) {
+    latencies[id].reserve(ops / consumers + 1);
+    threads.emplace_back([&, id] {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      uint64_t stamp;
+      while (consumed.load(std::memory_order_relaxed) < ops) {
+        if (buffer.TryPop(&stamp)) {
+          latencies[id].push_back(NowNs() - stamp);
+          consumed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  uint64_t start = NowNs();
+  go.store(true, std::memory_order_release);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  uint64_t elapsed = NowNs() - start;
+
+  std::vector<uint64_t> all;
+  for (const std::vector<uint64_t>& part : latencies) {
+    all.insert(all.end(), part.begin(), part.end());
+  }
+  return MakeResult(name, producers + consumers, producers, consumers,
+                    capacity, ops, elapsed, std::move(all));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchmarkArgs args(argc, argv);
+  uint64_t ops = args.Number("--ops", 1'000'000);
+  size_t max_threads = args.Number("--max-threads", 32);
+
+  const std::vector<size_t> capacities = {64, 1024, 65536};
+  std::vector<BenchmarkRow> results;
+  for (size_t capacity : capacities) {
+    {
+      RingBuffer<uint64_t> buffer(capacity);
+      results.push_back(
+          RunSingleThreaded("ring_buffer", buffer, capacity, ops));
+    }
+    {
+      SpscRingBuffer<uint64_t> buffer(capacity);
+      results.push_back(RunThreaded("spsc", buffer, 1, 1, capacity, ops));
+    }
+    // threads == 1 - база для масштабирования: один поток и кладёт, и
+    // забирает, как в RunSingleThreaded.
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+      MpmcRingBuffer<uint64_t> buffer(capacity);
+      if (threads == 1) {
+        results.push_back(RunSingleThreaded("mpmc", buffer, capacity, ops));
+        continue;
+      }
+      size_t producers = threads / 2;
+      size_t consumers = threads - producers;
+      results.push_back(
+          RunThreaded("mpmc", buffer, producers, consumers, capacity, ops));
+    }
+  }
+
+  WriteBenchmarkJson(args.OutPath(), "ring_buffer", results);
+  return 0;
+}
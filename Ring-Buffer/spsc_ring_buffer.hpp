@@ -0,0 +1,271 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "cache_line.hpp"
+#include "ring_buffer.hpp"
+#include "wait_strategy.hpp"
+
+// Исполнитель корутин: Post(handle) ставит handle в очередь на
+// возобновление и сразу возвращается.
+template <typename Executor>
+concept CoroutineExecutor =
+    requires(Executor& executor, std::coroutine_handle<> handle) {
+      executor.Post(handle);
+    };
+
+// Кольцевой буфер для одного производителя и одного потребителя.
+// TryPush вызывается только из потока-производителя, TryPop - только из
+// потока-потребителя; синхронизация - acquire/release на begin_ и end_.
+// TryPush/TryPop никого не будят: это только acquire/release на индексах.
+// Push/Pop блокируют поток (сначала крутятся, потом спят на futex), а
+// co_await Pop() усыпляет корутину-потребителя. Будят ждущих только
+// успешные Push/Pop и co_await Pop(), поэтому если одна сторона может
+// ждать, другая должна класть или забирать через них; Push/Pop с нулевым
+// таймаутом - неблокирующая попытка, которая будит.
+//
+// Корутину, ждущую в co_await Pop(), возобновляет производитель внутри
+// Push: до следующего co_await код потребителя выполняется в потоке
+// производителя и задерживает его. Такой код не должен делать того, что
+// можно только в потоке потребителя, - например, класть ответ в другой
+// SPSC-буфер, для которого поток потребителя - единственный производитель.
+// co_await Pop(executor) вместо этого передаёт корутину executor.Post(),
+// и она возобновляется там, где исполнитель её запустит.
+template <typename T = int, size_t kCapacity = kDynamicCapacity>
+class SpscRingBuffer {
+ public:
+  SpscRingBuffer()
+    requires(kCapacity != kDynamicCapacity)
+  = default;
+
+  explicit SpscRingBuffer(size_t capacity)
+    requires(kCapacity == kDynamicCapacity)
+      : storage_(capacity) {}
+
+  SpscRingBuffer(const SpscRingBuffer&) = delete;
+  SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+  size_t Size() const {
+    size_t begin = begin_.load(std::memory_order_acquire);
+    size_t end = end_.load(std::memory_order_acquire);
+    return (end > begin) ? end - begin : 0;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  size_t Capacity() const { return storage_.Capacity(); }
+
+  bool TryPush(const T& element) { return TryEmplace(element); }
+
+  bool TryPush(T&& element) { return TryEmplace(std::move(element)); }
+
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    size_t end = end_.load(std::memory_order_relaxed);
+    if (end - cached_begin_ == storage_.Capacity()) {
+      cached_begin_ = begin_.load(std::memory_order_acquire);
+      if (end - cached_begin_ == storage_.Capacity()) {
+        return false;
+      }
+    }
+    std::construct_at(storage_.Slot(end), std::forward<Args>(args)...);
+    end_.store(end + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T* element) {
+    return pop_with([element](T& slot) { *element = std::move(slot); });
+  }
+
+  template <typename Rep, typename Period>
+  bool Push(const T& element, std::chrono::duration<Rep, Period> timeout) {
+    return push_until(element, deadline_after(timeout));
+  }
+
+  template <typename Rep, typename Period>
+  bool Push(T&& element, std::chrono::duration<Rep, Period> timeout) {
+    return push_until(std::move(element), deadline_after(timeout));
+  }
+
+  void Push(const T& element) {
+    push_until(element, std::chrono::steady_clock::time_point::max());
+  }
+
+  void Push(T&& element) {
+    push_until(std::move(element), std::chrono::steady_clock::time_point::max());
+  }
+
+  template <typename Rep, typename Period>
+  bool Pop(T* element, std::chrono::duration<Rep, Period> timeout) {
+    return pop_until(element, deadline_after(timeout));
+  }
+
+  void Pop(T* element) {
+    pop_until(element, std::chrono::steady_clock::time_point::max());
+  }
+
+  class PopAwaiter;
+
+  // T value = co_await buffer.Pop(); ждать так может только одна корутина.
+  // Корутину возобновит производитель в своём потоке.
+  PopAwaiter Pop() {
+    return PopAwaiter(this, nullptr, [](void*, std::coroutine_handle<> handle) {
+      handle.resume();
+    });
+  }
+
+  // T value = co_await buffer.Pop(executor); если корутине придётся ждать,
+  // производитель отдаст её executor.Post(). Исполнитель должен жить, пока
+  // корутина не возобновится.
+  template <CoroutineExecutor Executor>
+  PopAwaiter Pop(Executor& executor) {
+    return PopAwaiter(this, &executor,
+                      [](void* context, std::coroutine_handle<> handle) {
+                        static_cast<Executor*>(context)->Post(handle);
+                      });
+  }
+
+  ~SpscRingBuffer() {
+    size_t end = end_.load(std::memory_order_acquire);
+    for (size_t ind = begin_.load(std::memory_order_relaxed); ind != end;
+         ++ind) {
+      std::destroy_at(storage_.Slot(ind));
+    }
+  }
+
+ private:
+  // begin_ и end_ растут монотонно, ячейка - storage_.Slot(индекс).
+  RingStorage<T, kCapacity> storage_;
+
+  // линия потребителя
+  alignas(kCacheLineSize) std::atomic<size_t> begin_ = 0;
+  size_t cached_end_ = 0;  // последнее увиденное потребителем значение end_
+
+  // линия производителя
+  alignas(kCacheLineSize) std::atomic<size_t> end_ = 0;
+  size_t cached_begin_ = 0;  // последнее увиденное производителем begin_
+  WaitEvent data_event_;     // ждёт потребитель, будит производитель
+  std::atomic<void*> awaiting_ = nullptr;  // корутина, ждущая элемента
+  // Как возобновить awaiting_; записываются до публикации awaiting_.
+  void (*resume_)(void*, std::coroutine_handle<>) = nullptr;
+  void* resume_context_ = nullptr;
+
+  alignas(kCacheLineSize) WaitEvent space_event_;  // ждёт производитель
+
+  template <typename Rep, typename Period>
+  static std::chrono::steady_clock::time_point deadline_after(
+      std::chrono::duration<Rep, Period> timeout) {
+    return std::chrono::steady_clock::now() +
+           std::chrono::ceil<std::chrono::steady_clock::duration>(timeout);
+  }
+
+  template <typename U>
+  bool push_until(U&& element,
+                  std::chrono::steady_clock::time_point deadline) {
+    // TryPush забирает element только в случае успеха.
+    if (!space_event_.WaitUntil(
+            [&] { return TryPush(std::forward<U>(element)); }, deadline)) {
+      return false;
+    }
+    notify_consumer();
+    return true;
+  }
+
+  bool pop_until(T* element, std::chrono::steady_clock::time_point deadline) {
+    if (!data_event_.WaitUntil([&] { return TryPop(element); }, deadline)) {
+      return false;
+    }
+    space_event_.Notify();
+    return true;
+  }
+
+  // Отдаёт первый элемент в consume(T&) и освобождает его ячейку.
+  template <typename Consume>
+  bool pop_with(Consume consume) {
+    size_t begin = begin_.load(std::memory_order_relaxed);
+    if (begin == cached_end_) {
+      cached_end_ = end_.load(std::memory_order_acquire);
+      if (begin == cached_end_) {
+        return false;
+      }
+    }
+    T* slot = storage_.Slot(begin);
+    consume(*slot);
+    std::destroy_at(slot);
+    begin_.store(begin + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Как TryPop, но элемент перемещается в пустой value.
+  bool try_pop_into(std::optional<T>& value) {
+    return pop_with([&value](T& slot) { value.emplace(std::move(slot)); });
+  }
+
+  void notify_consumer() {
+    data_event_.Notify();
+    if (awaiting_.load(std::memory_order_relaxed) != nullptr) {
+      void* address = awaiting_.exchange(nullptr, std::memory_order_acquire);
+      if (address != nullptr) {
+        resume_(resume_context_,
+                std::coroutine_handle<>::from_address(address));
+      }
+    }
+  }
+};
+
+template <typename T, size_t kCapacity>
+class SpscRingBuffer<T, kCapacity>::PopAwaiter {
+ public:
+  PopAwaiter(SpscRingBuffer* buffer, void* context,
+             void (*resume)(void*, std::coroutine_handle<>))
+      : buffer_(buffer), context_(context), resume_(resume) {}
+
+  bool await_ready() {
+    if (buffer_->try_pop_into(value_)) {
+      buffer_->space_event_.Notify();
+      return true;
+    }
+    return false;
+  }
+
+  bool await_suspend(std::coroutine_handle<> handle) {
+    // После публикации handle производитель может возобновить корутину и
+    // уничтожить этот объект, поэтому дальше используются только копии.
+    SpscRingBuffer* buffer = buffer_;
+    void* address = handle.address();
+    buffer->resume_ = resume_;
+    buffer->resume_context_ = context_;
+    // release: производитель возобновит корутину или отдаст исполнителю, и
+    // ему должны быть видны все записи потребителя до этой точки.
+    buffer->awaiting_.store(address, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!buffer->Empty() &&
+        buffer->awaiting_.exchange(nullptr, std::memory_order_acquire) ==
+            address) {
+      return false;
+    }
+    return true;
+  }
+
+  T await_resume() {
+    if (!value_) {
+      buffer_->try_pop_into(value_);
+      buffer_->space_event_.Notify();
+    }
+    return std::move(*value_);
+  }
+
+ private:
+  SpscRingBuffer* buffer_;
+  void* context_;
+  void (*resume_)(void*, std::coroutine_handle<>);
+  // Элемент конструируется только при успешном извлечении, так что T не
+  // обязан иметь конструктор по умолчанию.
+  std::optional<T> value_;
+};
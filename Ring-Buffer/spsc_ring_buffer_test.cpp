@@ -0,0 +1,244 @@
+// Нагрузочная проверка SpscRingBuffer двумя потоками: неблокирующие
+// TryPush/TryPop, блокирующие Push/Pop с таймаутом и без, co_await Pop() и
+// co_await Pop(executor).
+// Потребитель проверяет, что элементы приходят все и по порядку.
+//
+//   spsc_ring_buffer_test [--ops N]
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "spsc_ring_buffer.hpp"
+
+namespace {
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    std::cerr << what << " failed\n";
+    std::exit(1);
+  }
+}
+
+// Строка, чтобы в ячейках были нетривиальные объекты.
+std::string Value(uint64_t ind) { return std::to_string(ind) + "-payload"; }
+
+void TestTryPushTryPop(size_t capacity, uint64_t ops) {
+  SpscRingBuffer<std::string> buffer(capacity);
+  std::thread producer([&buffer, ops] {
+    for (uint64_t ind = 0; ind < ops;) {
+      if (buffer.TryPush(Value(ind))) {
+        ++ind;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+  std::string value;
+  for (uint64_t ind = 0; ind < ops;) {
+    if (buffer.TryPop(&value)) {
+      Check(value == Value(ind), "TryPop order");
+      ++ind;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  Check(buffer.Empty(), "TryPop leftovers");
+}
+
+// Обе стороны блокируются; половина операций - с таймаутом, который
+// истекает, пока другая сторона спит.
+void TestBlocking(size_t capacity, uint64_t ops) {
+  using namespace std::chrono_literals;
+  SpscRingBuffer<std::string> buffer(capacity);
+  std::thread producer([&buffer, ops] {
+    for (uint64_t ind = 0; ind < ops; ++ind) {
+      if (ind % 2 == 0) {
+        buffer.Push(Value(ind));
+      } else {
+        while (!buffer.Push(Value(ind), 10us)) {
+        }
+      }
+      if (ind % 4096 == 0) {
+        std::this_thread::sleep_for(1ms);
+      }
+    }
+  });
+  std::string value;
+  for (uint64_t ind = 0; ind < ops; ++ind) {
+    if (ind % 2 == 0) {
+      buffer.Pop(&value);
+    } else {
+      while (!buffer.Pop(&value, 10us)) {
+      }
+    }
+    Check(value == Value(ind), "Pop order");
+    if (ind % 5000 == 0) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }
+  producer.join();
+  Check(!buffer.Pop(&value, 0s), "Pop from empty buffer");
+}
+
+// Корутина, которая сразу начинает выполняться и останавливается в конце,
+// чтобы её состояние можно было проверить после join.
+struct Task {
+  struct promise_type {
+    Task get_return_object() {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_never initial_suspend() { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+Task Consume(SpscRingBuffer<std::string>& buffer, uint64_t ops,
+             uint64_t& received) {
+  for (uint64_t ind = 0; ind < ops; ++ind) {
+    std::string value = co_await buffer.Pop();
+    Check(value == Value(ind), "co_await Pop order");
+    ++received;
+  }
+}
+
+// Потребитель - корутина: её возобновляет производитель внутри Push.
+void TestCoroutine(size_t capacity, uint64_t ops) {
+  SpscRingBuffer<std::string> buffer(capacity);
+  uint64_t received = 0;
+  std::thread producer([&buffer, ops] {
+    for (uint64_t ind = 0; ind < ops; ++ind) {
+      buffer.Push(Value(ind));
+    }
+  });
+  Task task = Consume(buffer, ops, received);
+  producer.join();
+  Check(task.handle.done(), "coroutine finished");
+  Check(received == ops, "coroutine received");
+  task.handle.destroy();
+}
+
+// Элемент без конструктора по умолчанию.
+struct Ticket {
+  explicit Ticket(uint64_t num) : id(num) {}
+  uint64_t id;
+};
+
+Task ConsumeTickets(SpscRingBuffer<Ticket>& buffer, uint64_t count,
+                    uint64_t& received) {
+  for (uint64_t ind = 0; ind < count; ++ind) {
+    Ticket ticket = co_await buffer.Pop();
+    Check(ticket.id == ind, "co_await Pop of Ticket order");
+    ++received;
+  }
+}
+
+// co_await Pop() не требует от T конструктора по умолчанию: первый элемент
+// уже лежит в буфере, за остальными корутина засыпает.
+void TestNonDefaultConstructible() {
+  SpscRingBuffer<Ticket> buffer(4);
+  uint64_t received = 0;
+  buffer.Push(Ticket(0));
+  Task task = ConsumeTickets(buffer, 3, received);
+  Check(received == 1, "Ticket ready without waiting");
+  buffer.Push(Ticket(1));
+  buffer.Push(Ticket(2));
+  Check(task.handle.done() && received == 3, "Ticket after waiting");
+  task.handle.destroy();
+}
+
+// Исполнитель потока-потребителя: производитель кладёт корутины в очередь,
+// поток-потребитель возобновляет их у себя.
+class ConsumerLoop {
+ public:
+  void Post(std::coroutine_handle<> handle) { queue_.Push(handle); }
+
+  // Возобновляет корутины из очереди, пока task не завершится.
+  void Run(std::coroutine_handle<> task) {
+    using namespace std::chrono_literals;
+    std::coroutine_handle<> handle;
+    while (!task.done()) {
+      if (queue_.Pop(&handle, 1ms)) {
+        handle.resume();
+      }
+    }
+  }
+
+ private:
+  // Ждёт не больше одной корутины, так что второе место - с запасом.
+  SpscRingBuffer<std::coroutine_handle<>> queue_{2};
+};
+
+// Отвечает на каждый запрос через replies, для которых поток потребителя -
+// единственный производитель; поэтому корутина должна выполняться только в
+// нём.
+Task Echo(SpscRingBuffer<std::string>& requests,
+          SpscRingBuffer<std::string>& replies, ConsumerLoop& loop,
+          std::thread::id consumer, uint64_t ops) {
+  for (uint64_t ind = 0; ind < ops; ++ind) {
+    std::string value = co_await requests.Pop(loop);
+    Check(std::this_thread::get_id() == consumer, "executor thread");
+    Check(value == Value(ind), "co_await Pop(executor) order");
+    replies.Push(std::move(value));
+  }
+}
+
+// Производитель отдаёт ждущую корутину исполнителю, и та кладёт ответы из
+// потока потребителя, а производитель их забирает.
+void TestExecutor(size_t capacity, uint64_t ops) {
+  SpscRingBuffer<std::string> requests(capacity);
+  SpscRingBuffer<std::string> replies(capacity);
+  std::thread producer([&requests, &replies, capacity, ops] {
+    std::string reply;
+    uint64_t replied = 0;
+    for (uint64_t ind = 0; ind < ops; ++ind) {
+      requests.Push(Value(ind));
+      // Не больше capacity запросов без ответа: иначе обе стороны могут
+      // упереться в полные буферы.
+      if (ind + 1 - replied == capacity) {
+        replies.Pop(&reply);
+        Check(reply == Value(replied++), "reply order");
+      }
+    }
+    while (replied < ops) {
+      replies.Pop(&reply);
+      Check(reply == Value(replied++), "reply order");
+    }
+  });
+  ConsumerLoop loop;
+  Task task = Echo(requests, replies, loop, std::this_thread::get_id(), ops);
+  loop.Run(task.handle);
+  producer.join();
+  task.handle.destroy();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint64_t ops = 1'000'000;
+  for (int ind = 1; ind + 1 < argc; ind += 2) {
+    if (std::strcmp(argv[ind], "--ops") == 0) {
+      ops = std::strtoull(argv[ind + 1], nullptr, 10);
+    }
+  }
+  TestNonDefaultConstructible();
+  for (size_t capacity : {1, 2, 64}) {
+    TestTryPushTryPop(capacity, ops);
+    TestBlocking(capacity, ops / 10);
+    TestCoroutine(capacity, ops / 10);
+    TestExecutor(capacity, ops / 100);
+  }
+  std::cout << "ok\n";
+  return 0;
+}
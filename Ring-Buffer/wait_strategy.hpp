@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#endif
+
+// Сколько раз перепроверять условие, прежде чем уходить в ядро.
+inline constexpr int kSpinCount = 256;
+
+inline void SpinPause() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+// Засыпает, пока word == expected, но не дольше deadline. Возможны ложные
+// пробуждения, поэтому вызывающий перепроверяет своё условие в цикле.
+// time_point::max() - ждать без ограничения.
+inline void WaitOnWord(std::atomic<uint32_t>& word, uint32_t expected,
+                       std::chrono::steady_clock::time_point deadline) {
+  using std::chrono::steady_clock;
+#if defined(__linux__)
+  timespec timeout;
+  timespec* timeout_ptr = nullptr;
+  if (deadline != steady_clock::time_point::max()) {
+    auto remaining = deadline - steady_clock::now();
+    if (remaining <= steady_clock::duration::zero()) {
+      return;
+    }
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+    timeout.tv_sec = secs.count();
+    timeout.tv_nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(remaining - secs)
+            .count();
+    timeout_ptr = &timeout;
+  }
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+          expected, timeout_ptr, nullptr, 0);
+#else
+  if (deadline == steady_clock::time_point::max()) {
+    word.wait(expected, std::memory_order_acquire);
+    return;
+  }
+  while (word.load(std::memory_order_acquire) == expected &&
+         steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+#endif
+}
+
+inline void WakeAllOnWord(std::atomic<uint32_t>& word) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+          INT32_MAX, nullptr, nullptr, 0);
+#else
+  word.notify_all();
+#endif
+}
+
+// Событие для редкого ожидания: пока никто не ждёт, Notify - это барьер и
+// одно чтение, без системных вызовов.
+class WaitEvent {
+ public:
+  // Ждёт, пока ready() не вернёт true, или до deadline; возвращает ready().
+  // С уже прошедшим deadline - одна попытка, без кручения.
+  template <typename Predicate>
+  bool WaitUntil(Predicate ready,
+                 std::chrono::steady_clock::time_point deadline) {
+    for (int spin = 0; spin < kSpinCount; ++spin) {
+      if (ready()) {
+        return true;
+      }
+      if (spin == 0 && std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+      SpinPause();
+    }
+    while (true) {
+      uint32_t epoch = epoch_.load(std::memory_order_acquire);
+      waiting_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (ready()) {
+        waiting_.store(false, std::memory_order_relaxed);
+        return true;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        waiting_.store(false, std::memory_order_relaxed);
+        return false;
+      }
+      WaitOnWord(epoch_, epoch, deadline);
+    }
+  }
+
+  // Вызывается после публикации изменения, которого может ждать WaitUntil.
+  void Notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_relaxed)) {
+      waiting_.store(false, std::memory_order_relaxed);
+      epoch_.fetch_add(1, std::memory_order_release);
+      WakeAllOnWord(epoch_);
+    }
+  }
+
+ private:
+  std::atomic<uint32_t> epoch_ = 0;
+  std::atomic<bool> waiting_ = false;
+};